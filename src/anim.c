@@ -0,0 +1,87 @@
+#include "anim.h"
+#include <stdlib.h>
+
+static void smc_animator_advance(smc_animator *an, const smc_anim *a) {
+    switch (a->mode) {
+        case SMC_ANIM_LOOP:
+            an->pos = (an->pos + 1) % a->frame_c;
+            break;
+        case SMC_ANIM_ONCE:
+            if (an->pos + 1 < a->frame_c) ++an->pos;
+            else an->playing = false;
+            break;
+        case SMC_ANIM_PINGPONG:
+            if (a->frame_c < 2) break;
+            if ((an->dir > 0 && an->pos + 1 == a->frame_c) || (an->dir < 0 && an->pos == 0))
+                an->dir = -an->dir;
+            an->pos = an->dir > 0 ? an->pos + 1 : an->pos - 1;
+            break;
+    }
+}
+
+void smc_animators_add(smc_animators *a, smc_animator *an) {
+    if (a->count == a->cap) {
+        uint32_t cap = a->cap ? a->cap * 2 : 64;
+        smc_animator **data = realloc(a->data, cap * sizeof(smc_animator *));
+        if (!data) abort();
+        a->data = data;
+        a->cap = cap;
+    }
+    an->owner = a;
+    an->index = a->count;
+    a->data[a->count++] = an;
+}
+
+void smc_animators_step(smc_animators *a, float dt) {
+    for (uint32_t i = 0; i < a->count; ++i) {
+        smc_animator *an = a->data[i];
+        if (!an->playing || !an->spr) continue;
+        const smc_anim *anim = an->spr->anims + an->anim;
+        float step = 1 / anim->fps;
+        an->time += dt * an->speed;
+        while (an->playing && an->time >= step) {
+            an->time -= step;
+            smc_animator_advance(an, anim);
+        }
+        if (!an->playing) an->time = 0;
+    }
+}
+
+// Animators belong to their script handles, this only lets go of them
+void smc_animators_free(smc_animators *a) {
+    for (uint32_t i = 0; i < a->count; ++i) {
+        smc_animator *an = a->data[i];
+        solu_drelease(an->sprite);
+        an->sprite = SOLU_NIL;
+        an->spr = NULL;
+        an->owner = NULL;
+    }
+    free(a->data);
+    *a = (smc_animators){0};
+}
+
+// Playing the current animation again only restarts it when asked to
+void smc_animator_play(smc_animator *an, int anim, bool restart) {
+    if (anim == an->anim && an->playing && !restart) return;
+    an->anim = anim;
+    an->pos = 0;
+    an->time = 0;
+    an->dir = 1;
+    an->playing = true;
+}
+
+uint32_t smc_animator_frame(const smc_animator *an) {
+    if (an->anim < 0 || !an->spr) return 0;
+    return an->spr->anims[an->anim].frames[an->pos];
+}
+
+void smc_animator_free(smc_animator *an) {
+    if (an->owner) {
+        smc_animators *a = an->owner;
+        smc_animator *last = a->data[--a->count];
+        a->data[an->index] = last;
+        last->index = an->index;
+    }
+    solu_drelease(an->sprite);
+    free(an);
+}
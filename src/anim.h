@@ -0,0 +1,37 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include "asset.h"
+#include <solus/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Plays one of a sprite's named animations, all live animators are advanced
+// together once per step
+typedef struct smc_animator {
+    solu_val sprite; // Held so the frames outlive the animator
+    smc_spritedata *spr;
+    int anim;     // Index into spr->anims, -1 before the first play()
+    uint32_t pos; // Position within the animation's frames
+    float time, speed;
+    int dir; // Pingpong direction
+    bool playing;
+
+    struct smc_animators *owner;
+    uint32_t index;
+} smc_animator;
+
+typedef struct smc_animators {
+    smc_animator **data;
+    uint32_t count, cap;
+} smc_animators;
+
+void smc_animators_add(smc_animators *a, smc_animator *an);
+void smc_animators_step(smc_animators *a, float dt);
+void smc_animators_free(smc_animators *a);
+
+void smc_animator_play(smc_animator *an, int anim, bool restart);
+uint32_t smc_animator_frame(const smc_animator *an);
+void smc_animator_free(smc_animator *an);
+
+#endif // ANIM_H
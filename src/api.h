@@ -22,18 +22,58 @@ solu_call_ex smc_noset(solu_state *state);
 
 // State
 solu_call_ex smc_quit(solu_state *state);
+solu_call_ex smc_load_objects(solu_state *state);
+solu_call_ex smc_load_pooled(solu_state *state);
+solu_call_ex smc_load_invalidate(solu_state *state);
+solu_call_ex smc_get_object(solu_state *state);
+solu_call_ex smc_game_defer(solu_state *state);
 solu_call_ex smc_set_room(solu_state *state);
 solu_call_ex smc_set_title(solu_state *state);
 solu_call_ex smc_set_paused(solu_state *state);
 
-solu_val smc_object_new(smc_game *game, solu_i64 id, sf_str path);
+solu_val smc_object_new(smc_game *game, sf_str path);
+uint32_t smc_object_batch(smc_game *game, sf_str type, solu_val list, solu_val out);
 solu_call_ex smc_load_object(solu_state *state);
 solu_call_ex smc_delete(solu_state *state);
 
+// Timers
+bool smc_timer_fire(void *ud, solu_val fn, solu_i64 owner);
+solu_call_ex smc_game_after(solu_state *state);
+solu_call_ex smc_game_every(solu_state *state);
+solu_call_ex smc_timer_cancel(solu_state *state);
+
+// Events
+void smc_event_fire(void *ud, const char *name, solu_val fn, solu_i64 owner, solu_val payload);
+solu_call_ex smc_events_on(solu_state *state);
+solu_call_ex smc_events_off(solu_state *state);
+solu_call_ex smc_events_emit(solu_state *state);
+
 // Graphics
+solu_call_ex smc_sprite_open(solu_state *state, smc_game *game, char *name);
 solu_call_ex smc_load_sprite(solu_state *state);
 solu_call_ex smc_draw_sprite(solu_state *state);
 solu_call_ex smc_draw_rect(solu_state *state);
+solu_call_ex smc_sprite_animator(solu_state *state);
+solu_call_ex smc_animator_play_anim(solu_state *state);
+solu_call_ex smc_animator_stop(solu_state *state);
+solu_call_ex smc_animator_speed(solu_state *state);
+solu_call_ex smc_animator_frame_get(solu_state *state);
+solu_call_ex smc_animator_playing(solu_state *state);
+solu_call_ex smc_animator_draw(solu_state *state);
+
+// Tilemap
+int smc_tilemap_load(smc_game *game, solu_val room);
+void smc_tilemap_clear(smc_game *game);
+solu_call_ex smc_tiles_get(solu_state *state);
+solu_call_ex smc_tiles_set(solu_state *state);
+
+// Particles
+solu_call_ex smc_particles_emitter(solu_state *state);
+solu_call_ex smc_emitter_move(solu_state *state);
+solu_call_ex smc_emitter_rate(solu_state *state);
+solu_call_ex smc_emitter_burst(solu_state *state);
+solu_call_ex smc_emitter_count(solu_state *state);
+solu_call_ex smc_emitter_draw_all(solu_state *state);
 
 // Sound
 solu_call_ex smc_load_sound(solu_state *state);
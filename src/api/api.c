@@ -1,4 +1,5 @@
 #include "../api.h"
+#include "../object.h"
 
 const char SMC_DEFAULT_ROOM[] = "{ \n\
     name = 'Room'\n\
@@ -19,6 +20,9 @@ void smc_register(smc_game *g) {
     solu_dobj_strset(load.dyn, "sound", solu_wrapcfun(g->s, smc_load_sound, 1, &g->gptr, 1));
     solu_dobj_strset(load.dyn, "music", solu_wrapcfun(g->s, smc_load_music, 1, &g->gptr, 1));
     solu_dobj_strset(load.dyn, "object", solu_wrapcfun(g->s, smc_load_object, 2, &g->gptr, 1));
+    solu_dobj_strset(load.dyn, "objects", solu_wrapcfun(g->s, smc_load_objects, 2, &g->gptr, 1));
+    solu_dobj_strset(load.dyn, "pooled", solu_wrapcfun(g->s, smc_load_pooled, 2, &g->gptr, 1));
+    solu_dobj_strset(load.dyn, "invalidate", solu_wrapcfun(g->s, smc_load_invalidate, 1, &g->gptr, 1));
 
     solu_val draw = solu_dnew(g->s, SOLU_DOBJ);
     solu_dobj_strset(draw.dyn, "sprite", solu_wrapcfun(g->s, smc_draw_sprite, 7, &g->gptr, 1));
@@ -42,12 +46,34 @@ void smc_register(smc_game *g) {
     solu_dobj_strset(ctrl.dyn, "released", solu_wrapcfun(g->s, smc_ctrl_released, 1, &g->gptr, 1));
     solu_dobj_strset(ctrl.dyn, "axis", solu_wrapcfun(g->s, smc_ctrl_axis, 1, &g->gptr, 1));
 
+    solu_val events = solu_dnew(g->s, SOLU_DOBJ);
+    solu_dobj_strset(events.dyn, "on", solu_wrapcfun(g->s, smc_events_on, 2, &g->gptr, 1));
+    solu_dobj_strset(events.dyn, "off", solu_wrapcfun(g->s, smc_events_off, 1, &g->gptr, 1));
+    solu_dobj_strset(events.dyn, "emit", solu_wrapcfun(g->s, smc_events_emit, 2, &g->gptr, 1));
+
+    solu_val tiles = solu_dnew(g->s, SOLU_DOBJ);
+    solu_dobj_strset(tiles.dyn, "get", solu_wrapcfun(g->s, smc_tiles_get, 3, &g->gptr, 1));
+    solu_dobj_strset(tiles.dyn, "set", solu_wrapcfun(g->s, smc_tiles_set, 4, &g->gptr, 1));
+
+    solu_val particles = solu_dnew(g->s, SOLU_DOBJ);
+    solu_dobj_strset(particles.dyn, "emitter", solu_wrapcfun(g->s, smc_particles_emitter, 1, &g->gptr, 1));
+
     solu_val collider = solu_dnew(g->s, SOLU_DOBJ);
     solu_dobj_strset(collider.dyn, "new", solu_wrapcfun(g->s, smc_collider_new, 1, &g->gptr, 1));
 
     g->sprite = solu_dnew(g->s, SOLU_DOBJ);
     solu_dhold(g->sprite);
     solu_dobj_strset(g->sprite.dyn, "draw", solu_wrapmfun(g->s, smc_draw_sprite, 7, &g->gptr, 1));
+    solu_dobj_strset(g->sprite.dyn, "animator", solu_wrapmfun(g->s, smc_sprite_animator, 0, &g->gptr, 1));
+
+    g->animator = solu_dnew(g->s, SOLU_DOBJ);
+    solu_dhold(g->animator);
+    solu_dobj_strset(g->animator.dyn, "play", solu_wrapmfun(g->s, smc_animator_play_anim, 2, &g->gptr, 1));
+    solu_dobj_strset(g->animator.dyn, "stop", solu_wrapmfun(g->s, smc_animator_stop, 0, &g->gptr, 1));
+    solu_dobj_strset(g->animator.dyn, "speed", solu_wrapmfun(g->s, smc_animator_speed, 1, &g->gptr, 1));
+    solu_dobj_strset(g->animator.dyn, "frame", solu_wrapmfun(g->s, smc_animator_frame_get, 0, &g->gptr, 1));
+    solu_dobj_strset(g->animator.dyn, "playing", solu_wrapmfun(g->s, smc_animator_playing, 0, &g->gptr, 1));
+    solu_dobj_strset(g->animator.dyn, "draw", solu_wrapmfun(g->s, smc_animator_draw, 5, &g->gptr, 1));
 
     g->snd = solu_dnew(g->s, SOLU_DOBJ);
     solu_dhold(g->snd);
@@ -58,6 +84,20 @@ void smc_register(smc_game *g) {
     g->obj = solu_dnew(g->s, SOLU_DOBJ);
     solu_dhold(g->obj);
     solu_dobj_strset(g->obj.dyn, "delete", solu_wrapmfun(g->s, smc_delete, 1, &g->gptr, 1));
+    g->timer = solu_dnew(g->s, SOLU_DOBJ);
+    solu_dhold(g->timer);
+    solu_dobj_strset(g->timer.dyn, "cancel", solu_wrapmfun(g->s, smc_timer_cancel, 0, &g->gptr, 1));
+
+    g->emitter = solu_dnew(g->s, SOLU_DOBJ);
+    solu_dhold(g->emitter);
+    solu_dobj_strset(g->emitter.dyn, "move", solu_wrapmfun(g->s, smc_emitter_move, 2, &g->gptr, 1));
+    solu_dobj_strset(g->emitter.dyn, "rate", solu_wrapmfun(g->s, smc_emitter_rate, 1, &g->gptr, 1));
+    solu_dobj_strset(g->emitter.dyn, "burst", solu_wrapmfun(g->s, smc_emitter_burst, 1, &g->gptr, 1));
+    solu_dobj_strset(g->emitter.dyn, "count", solu_wrapmfun(g->s, smc_emitter_count, 0, &g->gptr, 1));
+    solu_dobj_strset(g->emitter.dyn, "draw", solu_wrapmfun(g->s, smc_emitter_draw_all, 0, &g->gptr, 1));
+
+    g->oset = solu_wrapcfun(g->s, smc_object_set, 3, &g->gptr, 1);
+    solu_dhold(g->oset);
 
     // Globals
     solu_setg(g->s, "delete", solu_wrapmfun(g->s, smc_delete, 1, &g->gptr, 1));
@@ -68,6 +108,9 @@ void smc_register(smc_game *g) {
     solu_setg(g->s, "mouse", mouse);
     solu_setg(g->s, "ctrl", ctrl);
     solu_setg(g->s, "collider", collider);
+    solu_setg(g->s, "events", events);
+    solu_setg(g->s, "particles", particles);
+    solu_setg(g->s, "tiles", tiles);
 }
 
 #include <SDL2/SDL.h>
@@ -27,11 +27,7 @@ static inline uint32_t *smc_find_parts(smc_game *g, smc_frect fr, uint32_t *size
     uint32_t h = max_y - min_y + 1;
     *size = w * h;
 
-    uint32_t *parts = malloc(sizeof(uint32_t) * *size);
-    if (!parts) {
-        *size = 0;
-        return NULL;
-    }
+    uint32_t *parts = smc_arena_alloc(&g->arena, sizeof(uint32_t) * *size);
     uint32_t n = 0;
     for (uint32_t y = min_y; y <= max_y; ++y)
         for (uint32_t x = min_x; x <= max_x; ++x)
@@ -54,7 +50,6 @@ static inline solu_call_ex smc_clear_collider(smc_game *g, solu_val collider) {
             }
         }
     }
-    free(parts);
     return solu_ok(collider);
 }
 static inline solu_call_ex smc_update_collider(smc_game *g, solu_val collider) {
@@ -66,7 +61,6 @@ static inline solu_call_ex smc_update_collider(smc_game *g, solu_val collider) {
         smc_partition *p = c->partitions + parts[i];
         smc_partition_push(p, collider.dyn);
     }
-    free(parts);
     return solu_ok(collider);
 }
 
@@ -92,7 +86,7 @@ solu_call_ex smc_collider_new(solu_state *s) {
     solu_val collider = solu_dnusr(s,
         sizeof(smc_collider),
         "collider",
-        &(smc_collider){g, g->id_c++, fr, false, true},
+        &(smc_collider){g, g->collider_c++, fr, false, true},
         smc_collider_delete,
         NULL
     );
@@ -116,11 +110,11 @@ solu_call_ex smc_collider_draw(solu_state *s) {
 
     smc_game *g = *(smc_game **)solu_capturec(s, 1).dyn;
     smc_collider *c = collider.dyn;
+    if (!g->render.active) return solu_ok(SOLU_NIL);
 
     int yofs = g->gui ? 0 : (int)-g->camera.y;
     int xofs = g->gui ? 0 : (int)-g->camera.x;
 
-    SDL_SetRenderDrawBlendMode(g->ren, SDL_BLENDMODE_BLEND);
     uint32_t pcount = 0;
     uint32_t *parts = smc_find_parts(g, c->rect, &pcount);
     if (parts) {
@@ -128,7 +122,6 @@ solu_call_ex smc_collider_draw(solu_state *s) {
             (g->collision_data.world.width + g->collision_data.grid - 1) /
             g->collision_data.grid
         );
-        SDL_SetRenderDrawColor(g->ren, 120, 120, 255, 175);
         for (uint32_t i = 0; i < pcount; ++i) {
             int y = (int)(parts[i] / cols);
             int x = (int)(parts[i] % cols);
@@ -138,13 +131,11 @@ solu_call_ex smc_collider_draw(solu_state *s) {
                 (int)g->collision_data.grid,
                 (int)g->collision_data.grid
             };
-            SDL_RenderFillRect(g->ren, &r);
+            smc_render_rect(&g->render, r, (SDL_Color){120, 120, 255, 175});
         }
-        free(parts);
     }
 
-    if (smc_collider_active(c)) SDL_SetRenderDrawColor(g->ren, 255, 0, 0, 175);
-    else SDL_SetRenderDrawColor(g->ren, 95, 95, 95, 175);
+    SDL_Color color = smc_collider_active(c) ? (SDL_Color){255, 0, 0, 175} : (SDL_Color){95, 95, 95, 175};
 
     SDL_Rect r = {
         (int)c->rect.x + xofs,
@@ -152,7 +143,7 @@ solu_call_ex smc_collider_draw(solu_state *s) {
         (int)c->rect.width,
         (int)c->rect.height
     };
-    SDL_RenderFillRect(g->ren, &r);
+    smc_render_rect(&g->render, r, color);
 
     return solu_ok(SOLU_NIL);
 }
@@ -216,12 +207,10 @@ solu_call_ex smc_collider_check(solu_state *s) {
             &&  a.y + a.height >= b.y
             &&  c->id != col->id
             &&  smc_collider_active(c)) {
-                free(parts);
                 return solu_ok((solu_val){SOLU_TDYN, .dyn=*(p->data + i)});
             }
         }
     }
-    free(parts);
     return solu_ok(SOLU_NIL);
 }
 
@@ -254,7 +243,6 @@ solu_call_ex smc_collider_check_all(solu_state *s) {
             }
         }
     }
-    free(parts);
     for (uint32_t i = 0; i < d->array.count; ++i)
         ((smc_collider *)d->array.data[i].dyn)->seen = false;
     return solu_ok(obj);
@@ -289,12 +277,10 @@ solu_call_ex smc_collider_check_type(solu_state *s) {
                 if (smc_collider_active(c)
                 &&  solu_isdtype(creator, SOLU_DOBJ)
                 &&  solu_streq(type, solu_dobj_strget(creator.dyn, "type"))) {
-                    free(parts);
                     return solu_ok((solu_val){SOLU_TDYN, .dyn=c});
                 }
             }
         }
     }
-    free(parts);
     return solu_ok(SOLU_NIL);
 }
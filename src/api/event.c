@@ -0,0 +1,70 @@
+#include "../api.h"
+#include "../object.h"
+
+void smc_event_fire(void *ud, const char *name, solu_val fn, solu_i64 owner, solu_val payload) {
+    smc_game *g = ud;
+    if (owner) {
+        smc_object *o = smc_object_get(g, owner);
+        if (!o) return;
+        solu_val obj = o->obj;
+        solu_dhold(obj);
+        smc_callfun(g, obj.dyn, fn, name, &payload, 1);
+        solu_drelease(obj);
+        return;
+    }
+
+    solu_call_ex call_ex = solu_call(g->s, fn.dyn, &payload, 1);
+    if (!call_ex.is_ok) {
+        smc_err("Event '%s' handler error: %s", name, call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt));
+        if (g->err_pause)
+            smc_pause(g, true);
+    }
+}
+
+solu_call_ex smc_events_on(solu_state *s) {
+    solu_val name = solu_get(s, 0);
+    solu_val fn = solu_get(s, 1);
+    if (!solu_isdtype(name, SOLU_DSTR))
+        return solu_err(s, "arg 'name' expected str got %s", solu_typename(name).c_str);
+    if (!solu_isdtype(fn, SOLU_DFUN))
+        return solu_err(s, "arg 'fn' expected fun got %s", solu_typename(fn).c_str);
+
+    // Subscriptions made by an object are dropped when it is deleted
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_object *o = NULL;
+    if (solu_isdtype(g->ocall, SOLU_DOBJ))
+        o = smc_object_get(g, solu_dobj_strget(g->ocall.dyn, "id").i64);
+
+    solu_i64 handle = smc_bus_on(
+        &g->events, sf_ref(name.dyn), fn,
+        o ? solu_dobj_strget(o->obj.dyn, "id").i64 : 0,
+        o ? &o->subs : NULL
+    );
+    return solu_ok(solu_dnusr(s, sizeof(solu_i64), "subscription", &handle, NULL, NULL));
+}
+
+solu_call_ex smc_events_off(solu_state *s) {
+    solu_val sub = solu_get(s, 0);
+    if (!solu_isutype(sub, sf_lit("subscription")))
+        return solu_err(s, "arg 'sub' expected subscription got %s", solu_typename(sub).c_str);
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    solu_i64 handle = *(solu_i64 *)sub.dyn;
+    smc_sub *data = smc_bus_get(&g->events, handle);
+    if (!data)
+        return solu_ok((solu_val){SOLU_TBOOL, .boolean = false});
+    smc_object *o = data->owner ? smc_object_get(g, data->owner) : NULL;
+    smc_bus_off(&g->events, handle, o ? &o->subs : NULL);
+    return solu_ok((solu_val){SOLU_TBOOL, .boolean = true});
+}
+
+solu_call_ex smc_events_emit(solu_state *s) {
+    solu_val name = solu_get(s, 0);
+    solu_val payload = solu_get(s, 1);
+    if (!solu_isdtype(name, SOLU_DSTR))
+        return solu_err(s, "arg 'name' expected str got %s", solu_typename(name).c_str);
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_bus_emit(&g->events, sf_ref(name.dyn), payload);
+    return solu_ok(SOLU_NIL);
+}
@@ -5,21 +5,17 @@ static void smc_spr_delete(void *_spr) {
     smc_spritedata *spr = *(smc_spritedata **)_spr;
     solu_valmap_delete(&((smc_game *)spr->g)->spr_cache, spr->name);
     smc_info("Unloaded sprite '%s'.", spr->name.c_str);
-    smc_spritedata_free(*spr);
+    smc_spritedata_free(&((smc_game *)spr->g)->render, *spr);
     free(spr);
 }
 
-solu_call_ex smc_load_sprite(solu_state *s) {
-    solu_val name = solu_get(s, 0);
-    if (!solu_isdtype(name, SOLU_DSTR))
-        return solu_err(s, "arg 'name' expected str got %s", solu_typename(name).c_str);
-
-    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
-    solu_valmap_ex exists = solu_valmap_get(&g->spr_cache, sf_ref(name.dyn));
+// Shared by load.sprite and room tile layers, loaded sprites are cached by name
+solu_call_ex smc_sprite_open(solu_state *s, smc_game *g, char *name) {
+    solu_valmap_ex exists = solu_valmap_get(&g->spr_cache, sf_ref(name));
     if (exists.is_ok)
         return solu_ok(exists.ok);
 
-    smc_spr_ex ex = smc_open_sprite(g->ren, s, g->spr_dir, name.dyn);
+    smc_spr_ex ex = smc_open_sprite(&g->render, &g->atlas, s, g->cache_dir, g->spr_dir, name);
     if (!ex.is_ok) {
         if (!ex.is_ok) {
             solu_call_ex res = solu_panic(s, "%s", ex.err.c_str);
@@ -52,21 +48,30 @@ solu_call_ex smc_load_sprite(solu_state *s) {
     infod->metadata[SOLU_META_EXTEND] = g->sprite;
     usr->metadata[SOLU_META_EXTEND] = info;
 
-    solu_valmap_set(&g->spr_cache, sf_str_cdup(name.dyn), out);
+    solu_valmap_set(&g->spr_cache, sf_str_cdup(name), out);
     return solu_ok(out);
 }
 
-solu_call_ex smc_draw_sprite(solu_state *s) {
-    solu_val sprite = solu_selfc(s);
-    solu_val x = solu_get(s, 1);
-    solu_val y = solu_get(s, 2);
-    solu_val frame = solu_get(s, 3);
-    solu_val rot = solu_get(s, 4);
-    solu_val scale = solu_get(s, 5);
-    solu_val color = solu_get(s, 6);
+solu_call_ex smc_load_sprite(solu_state *s) {
+    solu_val name = solu_get(s, 0);
+    if (!solu_isdtype(name, SOLU_DSTR))
+        return solu_err(s, "arg 'name' expected str got %s", solu_typename(name).c_str);
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    return smc_sprite_open(s, g, name.dyn);
+}
 
-    if (!solu_isutype(sprite, sf_lit("spr")))
-        return solu_err(s, "arg 'sprite' expected spr got %s", solu_typename(sprite).c_str);
+// Rejects draws whose screen-space bounds miss the view, counting them
+static bool smc_draw_visible(smc_game *g, float x, float y, float w, float h) {
+    if (x + w > 0 && y + h > 0 && x < g->resolution.x && y < g->resolution.y)
+        return true;
+    ++g->culled;
+    return false;
+}
+
+static solu_call_ex smc_sprite_submit(
+    solu_state *s, smc_spritedata *spr, solu_val frame,
+    solu_val x, solu_val y, solu_val rot, solu_val scale, solu_val color
+) {
     if (x.tt != SOLU_TI64) {
         if (x.tt == SOLU_TF64) x = (solu_val){SOLU_TI64, .i64=(solu_i64)x.f64};
         else return solu_err(s, "arg 'x' expected i64|f64 got %s", solu_typename(x).c_str);
@@ -112,43 +117,152 @@ solu_call_ex smc_draw_sprite(solu_state *s) {
     if (!g->drawing)
         return solu_panic(s, "Draw call outside of object:draw()");
 
-    smc_spritedata spr = **(smc_spritedata **)sprite.dyn;
-    if (frame.i64 > spr.frame_c - 1 || frame.i64 < 0)
-        return solu_panic(s, "Sprite '%s' does not contain frame %lld", spr.name.c_str, frame.i64);
+    if (frame.i64 > spr->frame_c - 1 || frame.i64 < 0)
+        return solu_panic(s, "Sprite '%s' does not contain frame %lld", spr->name.c_str, frame.i64);
 
-    smc_rect source = spr.frames[frame.i64];
+    if (!g->render.active) return solu_ok(SOLU_NIL);
+
+    smc_rect source = spr->frames[frame.i64];
     SDL_RendererFlip flip = SDL_FLIP_NONE;
     if (xscale < 0) flip |= SDL_FLIP_HORIZONTAL;
     if (yscale < 0) flip |= SDL_FLIP_VERTICAL;
 
-    SDL_SetTextureColorMod(spr.texture, c.r, c.g, c.b);
-    SDL_SetTextureAlphaMod(spr.texture, c.a);
-    SDL_SetTextureBlendMode(spr.texture, SDL_BLENDMODE_BLEND);
-    SDL_RenderCopyExF(
-        g->ren,
-        spr.texture,
-        &(SDL_Rect){
+    SDL_FRect dest = {
+        g->gui ? (float)x.i64 : (float)x.i64 - g->camera.x,
+        g->gui ? (float)y.i64 : (float)y.i64 - g->camera.y,
+        (float)source.width  * fabsf(xscale),
+        (float)source.height * fabsf(yscale)
+    };
+    SDL_FPoint origin = {
+        (float)source.origin.x * fabsf(xscale),
+        (float)source.origin.y * fabsf(yscale)
+    };
+    if (rot.f64 == 0) {
+        if (!smc_draw_visible(g, dest.x, dest.y, dest.w, dest.h))
+            return solu_ok(SOLU_NIL);
+    } else {
+        // Any rotation stays within the farthest corner's reach of the pivot
+        float rx = fmaxf(fabsf(origin.x), fabsf(dest.w - origin.x));
+        float ry = fmaxf(fabsf(origin.y), fabsf(dest.h - origin.y));
+        float reach = sqrtf(rx * rx + ry * ry);
+        if (!smc_draw_visible(g, dest.x + origin.x - reach, dest.y + origin.y - reach, reach * 2, reach * 2))
+            return solu_ok(SOLU_NIL);
+    }
+
+    smc_render_sprite(
+        &g->render,
+        spr->texture,
+        (SDL_Rect){
             (int)source.x,
             (int)source.y,
             (int)source.width,
             (int)source.height
         },
-        &(SDL_FRect){
-            g->gui ? (float)x.i64 : (float)x.i64 - g->camera.x,
-            g->gui ? (float)y.i64 : (float)y.i64 - g->camera.y,
-            (float)source.width  * fabsf(xscale),
-            (float)source.height * fabsf(yscale)
-        },
+        dest,
         (double)rot.f64,
-        &(SDL_FPoint){
-            (float)source.origin.x * fabsf(xscale),
-            (float)source.origin.y * fabsf(yscale)
-        },
-        flip
+        origin,
+        flip,
+        c
     );
     return solu_ok(SOLU_NIL);
 }
 
+solu_call_ex smc_draw_sprite(solu_state *s) {
+    solu_val sprite = solu_selfc(s);
+    if (!solu_isutype(sprite, sf_lit("spr")))
+        return solu_err(s, "arg 'sprite' expected spr got %s", solu_typename(sprite).c_str);
+    return smc_sprite_submit(
+        s, *(smc_spritedata **)sprite.dyn, solu_get(s, 3),
+        solu_get(s, 1), solu_get(s, 2), solu_get(s, 4), solu_get(s, 5), solu_get(s, 6)
+    );
+}
+
+static void smc_animator_delete(void *_an) {
+    smc_animator_free(*(smc_animator **)_an);
+}
+
+solu_call_ex smc_sprite_animator(solu_state *s) {
+    solu_val sprite = solu_selfc(s);
+    if (!solu_isutype(sprite, sf_lit("spr")))
+        return solu_panic(s, "'self' expected spr got %s", solu_typename(sprite).c_str);
+    smc_game *g = *(smc_game **)solu_capturec(s, 1).dyn;
+
+    smc_animator *an = malloc(sizeof(smc_animator));
+    if (!an) return solu_panic(s, "Out of memory");
+    *an = (smc_animator){
+        .sprite = sprite,
+        .spr = *(smc_spritedata **)sprite.dyn,
+        .anim = -1,
+        .speed = 1,
+        .dir = 1,
+    };
+    solu_dhold(sprite);
+    smc_animators_add(&g->animators, an);
+
+    solu_val out = solu_dnusr(s, sizeof(smc_animator *), "animator", &an, smc_animator_delete, NULL);
+    solu_dheader(out)->metadata[SOLU_META_EXTEND] = g->animator;
+    return solu_ok(out);
+}
+
+static smc_animator *smc_animator_self(solu_state *s) {
+    solu_val self = solu_selfc(s);
+    return solu_isutype(self, sf_lit("animator")) ? *(smc_animator **)self.dyn : NULL;
+}
+
+solu_call_ex smc_animator_play_anim(solu_state *s) {
+    smc_animator *an = smc_animator_self(s);
+    if (!an || !an->spr) return solu_panic(s, "'self' expected animator got %s", solu_typename(solu_selfc(s)).c_str);
+    solu_val name = solu_get(s, 1);
+    solu_val restart = solu_get(s, 2);
+    if (!solu_isdtype(name, SOLU_DSTR))
+        return solu_err(s, "arg 'name' expected str got %s", solu_typename(name).c_str);
+    int anim = smc_spritedata_anim(an->spr, name.dyn);
+    if (anim < 0)
+        return solu_panic(s, "Sprite '%s' has no animation '%s'", an->spr->name.c_str, (char *)name.dyn);
+    smc_animator_play(an, anim, restart.tt == SOLU_TBOOL && restart.boolean);
+    return solu_ok(SOLU_NIL);
+}
+
+solu_call_ex smc_animator_stop(solu_state *s) {
+    smc_animator *an = smc_animator_self(s);
+    if (!an) return solu_panic(s, "'self' expected animator got %s", solu_typename(solu_selfc(s)).c_str);
+    an->playing = false;
+    return solu_ok(SOLU_NIL);
+}
+
+solu_call_ex smc_animator_speed(solu_state *s) {
+    smc_animator *an = smc_animator_self(s);
+    if (!an) return solu_panic(s, "'self' expected animator got %s", solu_typename(solu_selfc(s)).c_str);
+    solu_val speed = solu_get(s, 1);
+    if (speed.tt != SOLU_TF64 && speed.tt != SOLU_TI64)
+        return solu_err(s, "arg 'speed' expected i64|f64 got %s", solu_typename(speed).c_str);
+    float v = speed.tt == SOLU_TF64 ? (float)speed.f64 : (float)speed.i64;
+    an->speed = v > 0 ? v : 0;
+    return solu_ok(SOLU_NIL);
+}
+
+solu_call_ex smc_animator_frame_get(solu_state *s) {
+    smc_animator *an = smc_animator_self(s);
+    if (!an) return solu_panic(s, "'self' expected animator got %s", solu_typename(solu_selfc(s)).c_str);
+    return solu_ok((solu_val){SOLU_TI64, .i64 = smc_animator_frame(an)});
+}
+
+solu_call_ex smc_animator_playing(solu_state *s) {
+    smc_animator *an = smc_animator_self(s);
+    if (!an) return solu_panic(s, "'self' expected animator got %s", solu_typename(solu_selfc(s)).c_str);
+    return solu_ok((solu_val){SOLU_TBOOL, .boolean = an->playing});
+}
+
+// animator:draw(x, y, rot, scale, color) draws the current frame
+solu_call_ex smc_animator_draw(solu_state *s) {
+    smc_animator *an = smc_animator_self(s);
+    if (!an || !an->spr) return solu_panic(s, "'self' expected animator got %s", solu_typename(solu_selfc(s)).c_str);
+    return smc_sprite_submit(
+        s, an->spr, (solu_val){SOLU_TI64, .i64 = smc_animator_frame(an)},
+        solu_get(s, 1), solu_get(s, 2), solu_get(s, 3), solu_get(s, 4), solu_get(s, 5)
+    );
+}
+
 solu_call_ex smc_draw_rect(solu_state *s) {
     solu_val x = solu_get(s, 0);
     solu_val y = solu_get(s, 1);
@@ -185,20 +299,26 @@ solu_call_ex smc_draw_rect(solu_state *s) {
     smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
     if (!g->drawing)
         return solu_panic(s, "Draw call outside of object:draw()");
+    if (!g->render.active) return solu_ok(SOLU_NIL);
 
-    SDL_SetRenderDrawBlendMode(g->ren, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(
-        g->ren,
-        (uint8_t)obj->array.data[0].i64,
-        (uint8_t)obj->array.data[1].i64,
-        (uint8_t)obj->array.data[2].i64,
-        (uint8_t)obj->array.data[3].i64
-    );
-    SDL_RenderFillRect(g->ren, &(SDL_Rect){
+    SDL_Rect rect = {
         g->gui ? (int)x.i64 : (int)(x.i64 - (solu_i64)g->camera.x),
         g->gui ? (int)y.i64 : (int)(y.i64 - (solu_i64)g->camera.y),
         (int)w.i64,
         (int)h.i64
+    };
+    // Negative sizes extend up/left, cull on the normalized bounds
+    float cx = (float)rect.x, cy = (float)rect.y, cw = (float)rect.w, ch = (float)rect.h;
+    if (cw < 0) { cx += cw; cw = -cw; }
+    if (ch < 0) { cy += ch; ch = -ch; }
+    if (!smc_draw_visible(g, cx, cy, cw, ch))
+        return solu_ok(SOLU_NIL);
+
+    smc_render_rect(&g->render, rect, (SDL_Color){
+        (uint8_t)obj->array.data[0].i64,
+        (uint8_t)obj->array.data[1].i64,
+        (uint8_t)obj->array.data[2].i64,
+        (uint8_t)obj->array.data[3].i64
     });
     return solu_ok(SOLU_NIL);
 }
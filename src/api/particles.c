@@ -0,0 +1,156 @@
+#include "../api.h"
+#include <math.h>
+
+static void smc_emitter_delete(void *_e) {
+    smc_emitter_free(*(smc_emitter **)_e);
+}
+
+static bool smc_opt_f64(solu_val opts, const char *name, float *out) {
+    solu_val v = solu_dobj_strget(opts.dyn, name);
+    if (v.tt == SOLU_TF64) *out = (float)v.f64;
+    else if (v.tt == SOLU_TI64) *out = (float)v.i64;
+    else return v.tt == SOLU_TNIL;
+    return true;
+}
+
+static bool smc_opt_vec2(solu_val opts, const char *name, float out[2]) {
+    solu_val v = solu_dobj_strget(opts.dyn, name);
+    if (v.tt == SOLU_TNIL) return true;
+    if (!solu_isdtype(v, SOLU_DOBJ)) return false;
+    solu_dobj *o = v.dyn;
+    if (o->array.count < 2) return false;
+    for (int i = 0; i < 2; ++i) {
+        solu_val n = o->array.data[i];
+        if (n.tt == SOLU_TF64) out[i] = (float)n.f64;
+        else if (n.tt == SOLU_TI64) out[i] = (float)n.i64;
+        else return false;
+    }
+    return true;
+}
+
+// particles.emitter{sprite, frame, x, y, rate, lifetime, jitter, velocity={x,y},
+// spread={x,y}, gravity={x,y}, scale, color={r,g,b,a}, fade, max}
+solu_call_ex smc_particles_emitter(solu_state *s) {
+    solu_val opts = solu_get(s, 0);
+    if (!solu_isdtype(opts, SOLU_DOBJ))
+        return solu_err(s, "arg 'opts' expected obj got %s", solu_typename(opts).c_str);
+    solu_val sprite = solu_dobj_strget(opts.dyn, "sprite");
+    if (!solu_isutype(sprite, sf_lit("spr")))
+        return solu_err(s, "opts.sprite expected spr got %s", solu_typename(sprite).c_str);
+    smc_spritedata *spr = *(smc_spritedata **)sprite.dyn;
+
+    smc_emitter e = {
+        .rate = 0, .lifetime = 1, .scale = 1,
+        .color = {255, 255, 255, 255},
+        .fade = true,
+        .seed = 0x9e3779b9u,
+    };
+    float frame = 0, cap = 0;
+    if (!smc_opt_f64(opts, "frame", &frame) ||
+        !smc_opt_f64(opts, "x", &e.px) ||
+        !smc_opt_f64(opts, "y", &e.py) ||
+        !smc_opt_f64(opts, "rate", &e.rate) ||
+        !smc_opt_f64(opts, "lifetime", &e.lifetime) ||
+        !smc_opt_f64(opts, "jitter", &e.jitter) ||
+        !smc_opt_f64(opts, "scale", &e.scale) ||
+        !smc_opt_f64(opts, "max", &cap))
+        return solu_err(s, "emitter options expected i64|f64 values");
+    if (!smc_opt_vec2(opts, "velocity", e.vel) ||
+        !smc_opt_vec2(opts, "spread", e.spread) ||
+        !smc_opt_vec2(opts, "gravity", e.gravity))
+        return solu_err(s, "emitter velocity, spread and gravity expected obj[2:f64]");
+    if (frame < 0 || (uint32_t)frame >= spr->frame_c)
+        return solu_panic(s, "Sprite '%s' does not contain frame %d", spr->name.c_str, (int)frame);
+    if (!(e.lifetime > 0) || e.rate < 0)
+        return solu_err(s, "emitter lifetime must be positive and rate not negative");
+    e.frame = spr->frames[(uint32_t)frame];
+
+    solu_val color = solu_dobj_strget(opts.dyn, "color");
+    if (solu_isdtype(color, SOLU_DOBJ)) {
+        solu_dobj *c = color.dyn;
+        if (c->array.count < 4)
+            return solu_err(s, "opts.color expected obj[4:i64]");
+        uint8_t rgba[4];
+        for (int i = 0; i < 4; ++i) {
+            if (c->array.data[i].tt != SOLU_TI64)
+                return solu_err(s, "opts.color expected obj[4:i64]");
+            rgba[i] = (uint8_t)min(max(c->array.data[i].i64, 0), UINT8_MAX);
+        }
+        e.color = (SDL_Color){rgba[0], rgba[1], rgba[2], rgba[3]};
+    }
+    solu_val fade = solu_dobj_strget(opts.dyn, "fade");
+    if (fade.tt == SOLU_TBOOL) e.fade = fade.boolean;
+
+    // Enough for a steady stream unless told otherwise, bursts past it are dropped
+    e.max = cap >= 1 ? (uint32_t)cap : (uint32_t)fmax(256, ceil(e.rate * (e.lifetime + e.jitter)));
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_emitter *out = malloc(sizeof(smc_emitter));
+    if (!out) return solu_panic(s, "Out of memory");
+    *out = e;
+    out->sprite = sprite;
+    out->spr = spr;
+    solu_dhold(sprite);
+    smc_particles_add(&g->particles, out);
+
+    solu_val handle = solu_dnusr(s, sizeof(smc_emitter *), "emitter", &out, smc_emitter_delete, NULL);
+    solu_dheader(handle)->metadata[SOLU_META_EXTEND] = g->emitter;
+    return solu_ok(handle);
+}
+
+static smc_emitter *smc_emitter_self(solu_state *s) {
+    solu_val self = solu_selfc(s);
+    return solu_isutype(self, sf_lit("emitter")) ? *(smc_emitter **)self.dyn : NULL;
+}
+
+solu_call_ex smc_emitter_move(solu_state *s) {
+    smc_emitter *e = smc_emitter_self(s);
+    if (!e) return solu_panic(s, "'self' expected emitter got %s", solu_typename(solu_selfc(s)).c_str);
+    solu_val x = solu_get(s, 1);
+    solu_val y = solu_get(s, 2);
+    if ((x.tt != SOLU_TF64 && x.tt != SOLU_TI64) || (y.tt != SOLU_TF64 && y.tt != SOLU_TI64))
+        return solu_err(s, "args 'x', 'y' expected i64|f64");
+    e->px = x.tt == SOLU_TF64 ? (float)x.f64 : (float)x.i64;
+    e->py = y.tt == SOLU_TF64 ? (float)y.f64 : (float)y.i64;
+    return solu_ok(SOLU_NIL);
+}
+
+solu_call_ex smc_emitter_rate(solu_state *s) {
+    smc_emitter *e = smc_emitter_self(s);
+    if (!e) return solu_panic(s, "'self' expected emitter got %s", solu_typename(solu_selfc(s)).c_str);
+    solu_val rate = solu_get(s, 1);
+    if (rate.tt != SOLU_TF64 && rate.tt != SOLU_TI64)
+        return solu_err(s, "arg 'rate' expected i64|f64 got %s", solu_typename(rate).c_str);
+    float r = rate.tt == SOLU_TF64 ? (float)rate.f64 : (float)rate.i64;
+    e->rate = r > 0 ? r : 0;
+    if (!e->rate) e->accum = 0;
+    return solu_ok(SOLU_NIL);
+}
+
+solu_call_ex smc_emitter_burst(solu_state *s) {
+    smc_emitter *e = smc_emitter_self(s);
+    if (!e) return solu_panic(s, "'self' expected emitter got %s", solu_typename(solu_selfc(s)).c_str);
+    solu_val n = solu_get(s, 1);
+    if (n.tt != SOLU_TI64)
+        return solu_err(s, "arg 'n' expected i64 got %s", solu_typename(n).c_str);
+    if (n.i64 > 0)
+        smc_emitter_spawn(e, (uint32_t)min(n.i64, UINT32_MAX));
+    return solu_ok(SOLU_NIL);
+}
+
+solu_call_ex smc_emitter_count(solu_state *s) {
+    smc_emitter *e = smc_emitter_self(s);
+    if (!e) return solu_panic(s, "'self' expected emitter got %s", solu_typename(solu_selfc(s)).c_str);
+    return solu_ok((solu_val){SOLU_TI64, .i64 = e->count});
+}
+
+solu_call_ex smc_emitter_draw_all(solu_state *s) {
+    smc_emitter *e = smc_emitter_self(s);
+    if (!e) return solu_panic(s, "'self' expected emitter got %s", solu_typename(solu_selfc(s)).c_str);
+    smc_game *g = *(smc_game **)solu_capturec(s, 1).dyn;
+    if (!g->drawing)
+        return solu_panic(s, "Draw call outside of object:draw()");
+    if (!g->render.active) return solu_ok(SOLU_NIL);
+    smc_emitter_draw(e, &g->render, g->gui ? 0 : g->camera.x, g->gui ? 0 : g->camera.y);
+    return solu_ok(SOLU_NIL);
+}
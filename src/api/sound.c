@@ -74,7 +74,7 @@ solu_call_ex smc_load_music(solu_state *s) {
     if (exists.is_ok && solu_isutype(exists.ok, sf_lit("mus")))
         return solu_ok(exists.ok);
 
-    smc_snd_ex ex = smc_open_music(s, g->snd_dir, name.dyn);
+    smc_snd_ex ex = smc_open_music(s, g->cache_dir, g->snd_dir, name.dyn);
     if (!ex.is_ok) {
         if (!ex.is_ok) {
             solu_call_ex res = solu_panic(s, "%s", ex.err.c_str);
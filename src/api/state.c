@@ -1,4 +1,5 @@
 #include "../api.h"
+#include "../object.h"
 #include "solus/api.h"
 #include <SDL2/SDL_video.h>
 
@@ -7,6 +8,32 @@ solu_call_ex smc_quit(solu_state *s) {
     return solu_ok(SOLU_NIL);
 }
 
+solu_call_ex smc_get_object(solu_state *s) {
+    solu_val id = solu_get(s, 0);
+    if (id.tt != SOLU_TI64)
+        return solu_err(s, "arg 'id' expected i64 got %s", solu_typename(id).c_str);
+    smc_object *o = smc_object_get(*(smc_game **)solu_capturec(s, 0).dyn, id.i64);
+    return solu_ok(o ? o->obj : SOLU_NIL);
+}
+
+// Jobs returning true are queued again, letting long work resume next frame.
+// A job deferred from an object waits while the game is paused, others run.
+solu_call_ex smc_game_defer(solu_state *s) {
+    solu_val fn = solu_get(s, 0);
+    if (!solu_isdtype(fn, SOLU_DFUN))
+        return solu_err(s, "arg 'fn' expected fun got %s", solu_typename(fn).c_str);
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_job job = {fn, 0};
+    if (solu_isdtype(g->ocall, SOLU_DOBJ)) {
+        solu_val id = solu_dobj_strget(g->ocall.dyn, "id");
+        if (id.tt == SOLU_TI64) job.owner = id.i64;
+    }
+    solu_dhold(fn);
+    smc_jobs_push(&g->jobs, job);
+    return solu_ok(SOLU_NIL);
+}
+
 solu_call_ex smc_set_room(solu_state *s) {
     smc_game *g = *(smc_game **)solu_capturec(s, 1).dyn;
     solu_val val = solu_get(s, 0);
@@ -31,7 +58,8 @@ solu_call_ex smc_set_title(solu_state *s) {
 
     if (g->title.c_str && sf_str_eq(g->title, sf_ref(val.dyn)))
         return solu_ok(val);
-    SDL_SetWindowTitle(g->win, val.dyn);
+    if (g->win)
+        SDL_SetWindowTitle(g->win, val.dyn);
     sf_str_free(g->title);
     g->title = sf_str_cdup(val.dyn);
     solu_dobj_strset(g->ginfo.dyn, "title", solu_dnstr(s, g->title.c_str));
@@ -51,51 +79,50 @@ solu_call_ex smc_set_paused(solu_state *s) {
     return solu_ok(val);
 }
 
-solu_val smc_object_new(smc_game *g, solu_i64 id, sf_str path) {
-    solu_val out = SOLU_NIL;
+// Object scripts are found and compiled once per type
+static solu_val smc_object_proto(smc_game *g, sf_str path, smc_prototype **out) {
+    smc_prototypes_ex cached = smc_prototypes_get(&g->prototypes, path);
+    if (cached.is_ok) {
+        *out = cached.ok;
+        return SOLU_NIL;
+    }
+
     char *rp = sf_str_fmt("%s/%s", g->obj_dir.c_str, path.c_str).c_str;
     char *rpath = solu_findfile(g->s, rp);
     free(rp);
     if (!rpath) {
         sf_str e = sf_str_fmt("Unable to locate object %s\n", path.c_str);
-        out = solu_dnerr(g->s, e.c_str);
+        solu_val er = solu_dnerr(g->s, e.c_str);
         sf_str_free(e);
-        return out;
+        return er;
     }
     rp = rpath;
 
-    solu_fproto fp;
-    if (smc_is_solc(rp)) {
-        solu_load_ex load_ex = solu_loadfun(g->s, rp);
-        if (!load_ex.is_ok) {
-            free(rp);
-            sf_str e = sf_str_fmt(
-                "Failed to compile object '%s': %s",
-                path.c_str, solu_err_string(load_ex.err)
-            );
-            solu_val er = solu_dnerr(g->s, e.c_str);
-            sf_str_free(e);
-            return er;
-        }
-        fp = load_ex.ok;
-    } else {
-        solu_compile_ex comp_ex = solu_cfile(g->s, rp);
-        if (!comp_ex.is_ok) {
-            char *trace = solu_ctrace_print(rp, comp_ex.err, 15, 2, 1);
-            free(rp);
-            sf_str e = sf_str_fmt(
-                "Failed to compile object '%s': %s",
-                path.c_str, trace
-            );
-            free(trace);
-            solu_val er = solu_dnerr(g->s, e.c_str);
-            sf_str_free(e);
-            return er;
-        }
-        fp = comp_ex.ok;
+    smc_proto_ex comp_ex = smc_compile(g->s, g->cache_dir, rp);
+    if (!comp_ex.is_ok) {
+        free(rp);
+        sf_str e = sf_str_fmt(
+            "Failed to compile object '%s': %s",
+            path.c_str, comp_ex.err.c_str
+        );
+        sf_str_free(comp_ex.err);
+        solu_val er = solu_dnerr(g->s, e.c_str);
+        sf_str_free(e);
+        return er;
     }
+    solu_fproto fp = comp_ex.ok;
+
+    smc_prototype *proto = malloc(sizeof(smc_prototype));
+    if (!proto) abort();
+    *proto = (smc_prototype){.path = rp, .fp = fp};
+    smc_prototypes_set(&g->prototypes, sf_str_cdup(path.c_str), proto);
+    *out = proto;
+    return SOLU_NIL;
+}
 
-    solu_call_ex call_ex = solu_call(g->s, &fp, NULL, 0);
+static solu_val smc_object_instance(smc_game *g, sf_str path, smc_prototype *proto) {
+    solu_val out = SOLU_NIL;
+    solu_call_ex call_ex = solu_call(g->s, &proto->fp, NULL, 0);
 
     if (!call_ex.is_ok) {
         sf_str e;
@@ -111,15 +138,11 @@ solu_val smc_object_new(smc_game *g, solu_i64 id, sf_str path) {
             TUI_ERR "Object %s:load() error: %s\n" TUI_CLEAR,
             path, call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt)
         );
-        free(rp);
-        solu_fproto_free(&fp);
         out = solu_dnerr(g->s, e.c_str);
         sf_str_free(e);
         return out;
     }
-    free(rp);
 
-    solu_fproto_free(&fp);
     if (!solu_isdtype(call_ex.ok, SOLU_DOBJ)) {
         sf_str e = sf_str_fmt("Expected gameobject to return obj, got %s\n", solu_typename(call_ex.ok).c_str);
         out = solu_dnerr(g->s, e.c_str);
@@ -128,17 +151,105 @@ solu_val smc_object_new(smc_game *g, solu_i64 id, sf_str path) {
     }
     out = call_ex.ok;
 
-    solu_val idv = {SOLU_TI64, .i64=id};
-    solu_dobj_strset(out.dyn, "id", idv);
     if (solu_dobj_strget(out.dyn, "depth").tt != SOLU_TF64)
         solu_dobj_strset(out.dyn, "depth", (solu_val){SOLU_TF64, .f64=0});
     solu_dobj_strset(out.dyn, "type", solu_dnstr(g->s, path.c_str));
-    solu_dobj_set(g->s, g->objects.dyn, idv, out);
     solu_dheader(out)->metadata[SOLU_META_EXTEND] = g->obj;
+    solu_dheader(out)->metadata[SOLU_META_SET] = g->oset;
+    smc_object_alloc(g, out);
 
     return out;
 }
 
+solu_val smc_object_new(smc_game *g, sf_str path) {
+    smc_prototype *proto = NULL;
+    solu_val er = smc_object_proto(g, path, &proto);
+    if (solu_isdtype(er, SOLU_DERR))
+        return er;
+    return smc_object_instance(g, path, proto);
+}
+
+// Every instance is built before any starts, so start() sees the whole batch.
+// With an empty type each field table names its own.
+uint32_t smc_object_batch(smc_game *g, sf_str type, solu_val list, solu_val out) {
+    solu_dobj *l = list.dyn;
+    uint32_t count = l->array.count;
+    if (!count) return 0;
+
+    smc_prototype *proto = NULL;
+    if (type.c_str) {
+        solu_val er = smc_object_proto(g, type, &proto);
+        if (solu_isdtype(er, SOLU_DERR)) {
+            smc_err("Object %s:load() error:\n-> %s", type.c_str, (char *)er.dyn);
+            return 0;
+        }
+    }
+
+    smc_object_reserve(g, count);
+    solu_i64 *ids = smc_arena_alloc(&g->arena, count * sizeof(solu_i64));
+    uint32_t n = 0;
+    solu_dhold(list);
+    for (uint32_t i = 0; i < count && i < l->array.count; ++i) {
+        solu_val fields = l->array.data[i];
+        sf_str t = type;
+        if (!proto) {
+            if (!solu_isdtype(fields, SOLU_DOBJ)) continue;
+            solu_val tv = solu_dobj_strget(fields.dyn, "type");
+            if (!solu_isdtype(tv, SOLU_DSTR)) continue;
+            t = sf_ref(tv.dyn);
+        }
+
+        solu_val obj = proto ? smc_object_instance(g, t, proto) : smc_object_new(g, t);
+        if (solu_isdtype(obj, SOLU_DERR)) {
+            smc_err("Object %s:load() error:\n-> %s", t.c_str, (char *)obj.dyn);
+            continue;
+        }
+        if (solu_isdtype(fields, SOLU_DOBJ))
+            solu_dappend(obj, fields);
+        ids[n++] = solu_dobj_strget(obj.dyn, "id").i64;
+        if (out.tt != SOLU_TNIL)
+            solu_valvec_push(&((solu_dobj *)out.dyn)->array, obj);
+    }
+    solu_drelease(list);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        smc_object *o = smc_object_get(g, ids[i]);
+        if (!o) continue; // Deleted by an earlier start()
+        solu_val obj = o->obj;
+        smc_object_bind(g, obj);
+        smc_callmethod(g, obj.dyn, "start");
+    }
+    return n;
+}
+
+solu_call_ex smc_load_objects(solu_state *s) {
+    solu_val type = solu_get(s, 0);
+    solu_val list = solu_get(s, 1);
+    if (!solu_isdtype(type, SOLU_DSTR))
+        return solu_err(s, "arg 'name' expected str got %s", solu_typename(type).c_str);
+    if (!solu_isdtype(list, SOLU_DOBJ))
+        return solu_err(s, "arg 'list' expected obj got %s", solu_typename(list).c_str);
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    solu_val out = solu_dnew(g->s, SOLU_DOBJ);
+    smc_object_batch(g, sf_ref(type.dyn), list, out);
+    return solu_ok(out);
+}
+
+solu_call_ex smc_load_invalidate(solu_state *s) {
+    solu_val type = solu_get(s, 0);
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    if (type.tt == SOLU_TNIL) {
+        smc_prototypes_free(&g->prototypes);
+        g->prototypes = smc_prototypes_new();
+        return solu_ok(SOLU_NIL);
+    }
+    if (!solu_isdtype(type, SOLU_DSTR))
+        return solu_err(s, "arg 'type' expected str got %s", solu_typename(type).c_str);
+    smc_prototypes_delete(&g->prototypes, sf_ref(type.dyn));
+    return solu_ok(SOLU_NIL);
+}
+
 solu_call_ex smc_load_object(solu_state *s) {
     solu_val type = solu_get(s, 0);
     solu_val fields = solu_get(s, 1);
@@ -146,14 +257,77 @@ solu_call_ex smc_load_object(solu_state *s) {
         return solu_err(s, "arg 'name' expected str got %s", solu_typename(type).c_str);
 
     smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
-    solu_val obj = smc_object_new(g, g->id_c++, sf_ref(type.dyn));
+    solu_val obj = smc_object_new(g, sf_ref(type.dyn));
+    if (solu_isdtype(obj, SOLU_DERR))
+        return solu_err(s, "Object %s:load() error:\n-> %s\n", (char *)type.dyn, (char *)obj.dyn);
+
+    smc_object_start(g, obj, fields);
+
+    return solu_ok(obj);
+}
+
+// Idle instances are held until reused or the type is invalidated
+static void smc_pool_push(smc_game *g, solu_val obj) {
+    solu_val type = solu_dobj_strget(obj.dyn, "type");
+    if (!solu_isdtype(type, SOLU_DSTR)) return;
+    smc_prototypes_ex cached = smc_prototypes_get(&g->prototypes, sf_ref(type.dyn));
+    if (!cached.is_ok) return;
+
+    smc_prototype *proto = cached.ok;
+    if (proto->pool_c == SMC_POOL_MAX) return;
+    if (proto->pool_c == proto->pool_cap) {
+        uint32_t cap = proto->pool_cap ? proto->pool_cap * 2 : 16;
+        solu_val *pool = realloc(proto->pool, cap * sizeof(solu_val));
+        if (!pool) return;
+        proto->pool = pool;
+        proto->pool_cap = cap;
+    }
+    proto->pool[proto->pool_c++] = obj;
+    solu_dhold(obj);
+}
+
+solu_call_ex smc_load_pooled(solu_state *s) {
+    solu_val type = solu_get(s, 0);
+    solu_val fields = solu_get(s, 1);
+    if (!solu_isdtype(type, SOLU_DSTR))
+        return solu_err(s, "arg 'name' expected str got %s", solu_typename(type).c_str);
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_prototype *proto = NULL;
+    solu_val obj = smc_object_proto(g, sf_ref(type.dyn), &proto);
     if (solu_isdtype(obj, SOLU_DERR))
-        return solu_err(s, "Object [%u]:%s:load() error:\n-> %s\n", g->id_c - 1, (char *)type.dyn, (char *)obj.dyn);
+        return solu_err(s, "Object %s:load() error:\n-> %s\n", (char *)type.dyn, (char *)obj.dyn);
+    if (proto->resettable < 0)
+        return solu_err(s, "Object %s needs reset() to be loaded pooled", (char *)type.dyn);
 
-    if (solu_isdtype(fields, SOLU_DOBJ))
-        solu_dappend(obj, fields);
-    smc_callmethod(g, obj.dyn, "start");
+    bool recycled = proto->pool_c;
+    if (recycled) {
+        // The record takes over the pool's reference
+        obj = proto->pool[--proto->pool_c];
+        smc_object_alloc(g, obj);
+        solu_drelease(obj);
+    } else {
+        obj = smc_object_new(g, sf_ref(type.dyn));
+        if (solu_isdtype(obj, SOLU_DERR))
+            return solu_err(s, "Object %s:load() error:\n-> %s\n", (char *)type.dyn, (char *)obj.dyn);
+    }
+
+    // Recycled instances keep every field from their last life, body, depth
+    // and activity included, reset() is what makes them fresh again
+    // Checked once on the first instance, later calls fail without building one
+    solu_i64 id = solu_dobj_strget(obj.dyn, "id").i64;
+    if (!proto->resettable)
+        proto->resettable = solu_isdtype(solu_dobj_strget(obj.dyn, "reset"), SOLU_DFUN) ? 1 : -1;
+    if (proto->resettable < 0) {
+        smc_object_release(g, id);
+        return solu_err(s, "Object %s needs reset() to be loaded pooled", (char *)type.dyn);
+    }
+    if (recycled)
+        smc_callmethod(g, obj.dyn, "reset");
 
+    smc_object *o = smc_object_get(g, id);
+    if (o) o->pooled = true;
+    smc_object_start(g, obj, fields);
     return solu_ok(obj);
 }
 
@@ -165,10 +339,15 @@ solu_call_ex smc_delete(solu_state *s) {
     if (id.tt != SOLU_TI64)
         return solu_panic(s, "self.id expected i64, found %s", solu_typename(self).c_str);
     smc_game *g = *(smc_game **)solu_capturec(s, 1).dyn;
-    solu_dobj *d = g->objects.dyn;
-    if (id.i64 < 0 || id.i64 > d->array.count - 1 || id.i64 > UINT32_MAX)
+    smc_object *o = smc_object_get(g, id.i64);
+    if (!o || o->obj.dyn != self.dyn)
         return solu_panic(s, "self.id is invalid");
+    bool pooled = o->pooled;
     smc_callmethod(g, self.dyn, "cleanup");
-    solu_valvec_set(&((solu_dobj *)g->objects.dyn)->array, (uint32_t)id.i64, SOLU_NIL);
+    if (!smc_object_get(g, id.i64)) // Deleted itself in cleanup()
+        return solu_ok(SOLU_NIL);
+    if (pooled)
+        smc_pool_push(g, self);
+    smc_object_release(g, id.i64);
     return solu_ok(SOLU_NIL);
 }
@@ -0,0 +1,127 @@
+#include "../api.h"
+
+void smc_tilemap_clear(smc_game *g) {
+    for (uint32_t i = 0; i < g->layer_c; ++i)
+        smc_layer_free(&g->render, g->layers + i);
+    free(g->layers);
+    g->layers = NULL;
+    g->layer_c = 0;
+}
+
+static int smc_layer_cmp(const void *a, const void *b) {
+    solu_f64 da = ((const smc_layer *)a)->depth, db = ((const smc_layer *)b)->depth;
+    return (da > db) - (da < db);
+}
+
+static solu_f64 smc_layer_num(solu_val def, const char *name) {
+    solu_val v = solu_dobj_strget(def.dyn, name);
+    return v.tt == SOLU_TF64 ? v.f64 : v.tt == SOLU_TI64 ? (solu_f64)v.i64 : 0;
+}
+
+// layers = { { name = 'ground', sprite = 'tiles', width = 40, tiles = {...},
+// depth = 10, x = 0, y = 0 }, ... } with tiles in rows of 'width'
+int smc_tilemap_load(smc_game *g, solu_val room) {
+    smc_tilemap_clear(g);
+    solu_val layers = solu_dobj_strget(room.dyn, "layers");
+    if (layers.tt == SOLU_TNIL) return 0;
+    solu_dobj *l_obj = layers.dyn;
+    if (!solu_isdtype(layers, SOLU_DOBJ)) {
+        smc_err("Expected layers:obj in room", NULL);
+        return -1;
+    }
+    if (!l_obj->array.count) return 0;
+
+    g->layers = calloc(l_obj->array.count, sizeof(smc_layer));
+    for (uint32_t i = 0; i < l_obj->array.count; ++i) {
+        solu_val def = l_obj->array.data[i];
+        solu_val name = solu_isdtype(def, SOLU_DOBJ) ? solu_dobj_strget(def.dyn, "name") : SOLU_NIL;
+        solu_val sprite = solu_isdtype(def, SOLU_DOBJ) ? solu_dobj_strget(def.dyn, "sprite") : SOLU_NIL;
+        solu_val width = solu_isdtype(def, SOLU_DOBJ) ? solu_dobj_strget(def.dyn, "width") : SOLU_NIL;
+        solu_val tiles = solu_isdtype(def, SOLU_DOBJ) ? solu_dobj_strget(def.dyn, "tiles") : SOLU_NIL;
+        solu_dobj *t_obj = tiles.dyn;
+        if (!solu_isdtype(name, SOLU_DSTR) || !solu_isdtype(sprite, SOLU_DSTR) ||
+            width.tt != SOLU_TI64 || width.i64 <= 0 || !solu_isdtype(tiles, SOLU_DOBJ)) {
+            smc_err("Expected layers[%u] to contain name:str, sprite:str, width:i64 and tiles:obj", i);
+            return -1;
+        }
+
+        solu_call_ex spr_ex = smc_sprite_open(g->s, g, sprite.dyn);
+        if (!spr_ex.is_ok) {
+            smc_err("Layer '%s': %s", (char *)name.dyn, spr_ex.err.panic ? spr_ex.err.panic : solu_err_string(spr_ex.err.tt));
+            return -1;
+        }
+        smc_spritedata *spr = *(smc_spritedata **)spr_ex.ok.dyn;
+
+        smc_layer *l = g->layers + g->layer_c++;
+        *l = (smc_layer){
+            .name = sf_str_cdup(name.dyn),
+            .sprite = spr_ex.ok,
+            .spr = spr,
+            .width = (uint32_t)width.i64,
+            .tile_w = spr->frames[0].width,
+            .tile_h = spr->frames[0].height,
+            .x = (float)smc_layer_num(def, "x"),
+            .y = (float)smc_layer_num(def, "y"),
+            .depth = smc_layer_num(def, "depth"),
+        };
+        solu_dhold(l->sprite);
+        l->height = (t_obj->array.count + l->width - 1) / l->width;
+        l->tiles = malloc((size_t)l->width * l->height * sizeof(int32_t));
+        for (uint32_t t = 0; t < l->width * l->height; ++t) {
+            solu_val v = t < t_obj->array.count ? t_obj->array.data[t] : SOLU_NIL;
+            l->tiles[t] = v.tt == SOLU_TI64 && v.i64 >= 0 && v.i64 < spr->frame_c ? (int32_t)v.i64 : -1;
+        }
+        l->chunk_w = (l->width + SMC_CHUNK_TILES - 1) / SMC_CHUNK_TILES;
+        l->chunk_h = (l->height + SMC_CHUNK_TILES - 1) / SMC_CHUNK_TILES;
+        l->chunks = calloc((size_t)l->chunk_w * l->chunk_h, sizeof(smc_chunk));
+        for (uint32_t c = 0; c < l->chunk_w * l->chunk_h; ++c)
+            l->chunks[c].dirty = true;
+    }
+    // Drawn interleaved with objects by depth, the order is fixed per room
+    qsort(g->layers, g->layer_c, sizeof(smc_layer), smc_layer_cmp);
+    return 0;
+}
+
+static smc_layer *smc_layer_find(smc_game *g, solu_val name) {
+    if (!solu_isdtype(name, SOLU_DSTR)) return NULL;
+    for (uint32_t i = 0; i < g->layer_c; ++i)
+        if (strcmp(g->layers[i].name.c_str, name.dyn) == 0) return g->layers + i;
+    return NULL;
+}
+
+// tiles.get(layer, tx, ty) is nil outside the layer and -1 on empty tiles
+solu_call_ex smc_tiles_get(solu_state *s) {
+    solu_val name = solu_get(s, 0);
+    solu_val tx = solu_get(s, 1);
+    solu_val ty = solu_get(s, 2);
+    if (tx.tt != SOLU_TI64 || ty.tt != SOLU_TI64)
+        return solu_err(s, "args 'tx', 'ty' expected i64");
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_layer *l = smc_layer_find(g, name);
+    if (!l)
+        return solu_err(s, "arg 'layer' expected a layer name of this room");
+    if (tx.i64 < 0 || ty.i64 < 0 || tx.i64 >= l->width || ty.i64 >= l->height)
+        return solu_ok(SOLU_NIL);
+    return solu_ok((solu_val){SOLU_TI64, .i64 = l->tiles[ty.i64 * l->width + tx.i64]});
+}
+
+solu_call_ex smc_tiles_set(solu_state *s) {
+    solu_val name = solu_get(s, 0);
+    solu_val tx = solu_get(s, 1);
+    solu_val ty = solu_get(s, 2);
+    solu_val tile = solu_get(s, 3);
+    if (tx.tt != SOLU_TI64 || ty.tt != SOLU_TI64)
+        return solu_err(s, "args 'tx', 'ty' expected i64");
+    if (tile.tt != SOLU_TI64)
+        return solu_err(s, "arg 'tile' expected i64 got %s", solu_typename(tile).c_str);
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    smc_layer *l = smc_layer_find(g, name);
+    if (!l)
+        return solu_err(s, "arg 'layer' expected a layer name of this room");
+    if (tx.i64 < 0 || ty.i64 < 0 || tx.i64 >= l->width || ty.i64 >= l->height)
+        return solu_err(s, "Tile %lld,%lld is outside layer '%s'", tx.i64, ty.i64, l->name.c_str);
+    if (tile.i64 >= l->spr->frame_c)
+        return solu_panic(s, "Sprite '%s' does not contain frame %lld", l->spr->name.c_str, tile.i64);
+    smc_layer_set(l, (uint32_t)tx.i64, (uint32_t)ty.i64, tile.i64 < 0 ? -1 : (int32_t)tile.i64);
+    return solu_ok(SOLU_NIL);
+}
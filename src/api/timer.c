@@ -0,0 +1,67 @@
+#include "../api.h"
+#include "../object.h"
+#include <math.h>
+
+// Timers created by an object die with it
+bool smc_timer_fire(void *ud, solu_val fn, solu_i64 owner) {
+    smc_game *g = ud;
+    if (owner) {
+        smc_object *o = smc_object_get(g, owner);
+        if (!o) return false;
+        solu_val obj = o->obj;
+        solu_dhold(obj);
+        smc_callfun(g, obj.dyn, fn, "timer", NULL, 0);
+        solu_drelease(obj);
+        return true;
+    }
+
+    solu_call_ex call_ex = solu_call(g->s, fn.dyn, NULL, 0);
+    if (!call_ex.is_ok) {
+        smc_err("Timer error: %s", call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt));
+        if (g->err_pause)
+            smc_pause(g, true);
+    }
+    return true;
+}
+
+static solu_call_ex smc_timer_new(solu_state *s, bool repeat) {
+    solu_val secs = solu_get(s, 0);
+    solu_val fn = solu_get(s, 1);
+    if (secs.tt != SOLU_TF64 && secs.tt != SOLU_TI64)
+        return solu_err(s, "arg 'seconds' expected f64 got %s", solu_typename(secs).c_str);
+    if (!solu_isdtype(fn, SOLU_DFUN))
+        return solu_err(s, "arg 'fn' expected fun got %s", solu_typename(fn).c_str);
+    solu_f64 sec = secs.tt == SOLU_TF64 ? secs.f64 : (solu_f64)secs.i64;
+    if (!(sec >= 0))
+        return solu_err(s, "arg 'seconds' must not be negative");
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    solu_i64 owner = 0;
+    if (solu_isdtype(g->ocall, SOLU_DOBJ)) {
+        solu_val id = solu_dobj_strget(g->ocall.dyn, "id");
+        if (id.tt == SOLU_TI64) owner = id.i64;
+    }
+
+    uint64_t ms = (uint64_t)ceil(sec * 1000);
+    solu_i64 handle = smc_wheel_add(&g->timers, fn, owner, ms, repeat ? (ms ? ms : 1) : 0);
+    solu_val out = solu_dnusr(s, sizeof(solu_i64), "timer", &handle, NULL, NULL);
+    solu_dheader(out)->metadata[SOLU_META_EXTEND] = g->timer;
+    return solu_ok(out);
+}
+
+solu_call_ex smc_game_after(solu_state *s) {
+    return smc_timer_new(s, false);
+}
+
+solu_call_ex smc_game_every(solu_state *s) {
+    return smc_timer_new(s, true);
+}
+
+solu_call_ex smc_timer_cancel(solu_state *s) {
+    solu_val self = solu_selfc(s);
+    if (!solu_isutype(self, sf_lit("timer")))
+        return solu_panic(s, "'self' expected timer got %s", solu_typename(self).c_str);
+    smc_game *g = *(smc_game **)solu_capturec(s, 1).dyn;
+    bool pending = smc_wheel_cancel(&g->timers, *(solu_i64 *)self.dyn);
+    return solu_ok((solu_val){SOLU_TBOOL, .boolean = pending});
+}
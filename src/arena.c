@@ -0,0 +1,51 @@
+#include "arena.h"
+#include <stdlib.h>
+
+static smc_arena_block *smc_arena_block_new(size_t size) {
+    smc_arena_block *b = malloc(sizeof(smc_arena_block) + size);
+    if (!b) abort();
+    *b = (smc_arena_block){.size = size};
+    return b;
+}
+
+void *smc_arena_alloc(smc_arena *a, size_t size) {
+    size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+    smc_arena_block *b = a->head;
+    if (!b || b->size - b->used < size) {
+        size_t bsize = b ? b->size * 2 : SMC_ARENA_BLOCK;
+        while (bsize < size) bsize *= 2;
+        b = smc_arena_block_new(bsize);
+        b->next = a->head;
+        a->head = b;
+        a->capacity += bsize;
+    }
+    void *p = b->data + b->used;
+    b->used += size;
+    a->used += size;
+    return p;
+}
+
+void smc_arena_reset(smc_arena *a) {
+    if (a->used > a->peak)
+        a->peak = a->used;
+    a->used = 0;
+    if (!a->head) return;
+
+    // Overflowed into more blocks, fold them into one big enough for next frame
+    if (a->head->next) {
+        size_t capacity = a->capacity;
+        smc_arena_free(a);
+        a->head = smc_arena_block_new(capacity);
+        a->capacity = capacity;
+    }
+    a->head->used = 0;
+}
+
+void smc_arena_free(smc_arena *a) {
+    for (smc_arena_block *b = a->head, *next; b; b = next) {
+        next = b->next;
+        free(b);
+    }
+    a->head = NULL;
+    a->capacity = 0;
+}
@@ -0,0 +1,25 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SMC_ARENA_BLOCK (64 * 1024)
+
+typedef struct smc_arena_block {
+    struct smc_arena_block *next;
+    size_t size, used;
+    _Alignas(max_align_t) unsigned char data[];
+} smc_arena_block;
+
+// Bump allocator for memory that only lives until the end of the frame
+typedef struct {
+    smc_arena_block *head;
+    size_t used, capacity, peak;
+} smc_arena;
+
+void *smc_arena_alloc(smc_arena *arena, size_t size);
+void smc_arena_reset(smc_arena *arena);
+void smc_arena_free(smc_arena *arena);
+
+#endif // ARENA_H
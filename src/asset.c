@@ -6,8 +6,11 @@
 #include <sf/fs.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_render.h>
+#include <inttypes.h>
 #include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 const char SMC_DEFAULT_CONFIG[] = "{\n\
     title = 'solumicro'\n\
@@ -24,7 +27,166 @@ const char SMC_DEFAULT_CONFIG[] = "{\n\
     }\n\
 }";
 
-smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, char *name) {
+#define SMC_CACHE_VERSION 1
+
+static uint64_t smc_fnv1a(uint64_t h, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Named by source path alone so an edited script replaces its entry, the
+// stamp beside it records what the bytecode was compiled from
+typedef struct {
+    int64_t version, mtime, size;
+} smc_cache_key;
+
+static char *smc_cache_path(sf_str cache_dir, char *path, smc_cache_key *key) {
+    struct stat st;
+    if (!cache_dir.c_str || stat(path, &st) != 0)
+        return NULL;
+    *key = (smc_cache_key){SMC_CACHE_VERSION, (int64_t)st.st_mtime, (int64_t)st.st_size};
+    uint64_t h = smc_fnv1a(0xcbf29ce484222325ULL, path, strlen(path));
+    return sf_str_fmt("%s/%016" PRIx64 ".solc", cache_dir.c_str, h).c_str;
+}
+
+static bool smc_cache_fresh(char *cpath, const smc_cache_key *key) {
+    char *kpath = sf_str_fmt("%s.key", cpath).c_str;
+    FILE *f = fopen(kpath, "rb");
+    free(kpath);
+    if (!f) return false;
+    smc_cache_key stamp;
+    bool fresh = fread(&stamp, sizeof(stamp), 1, f) == 1
+        && stamp.version == key->version && stamp.mtime == key->mtime && stamp.size == key->size;
+    fclose(f);
+    return fresh;
+}
+
+static bool smc_cache_stamp(char *cpath, const smc_cache_key *key) {
+    char *kpath = sf_str_fmt("%s.key", cpath).c_str;
+    FILE *f = fopen(kpath, "wb");
+    bool ok = f && fwrite(key, sizeof(*key), 1, f) == 1;
+    if (f && fclose(f) != 0) ok = false;
+    if (!ok) remove(kpath);
+    free(kpath);
+    return ok;
+}
+
+smc_proto_ex smc_compile(solu_state *s, sf_str cache_dir, char *path) {
+    if (smc_is_solc(path)) {
+        solu_load_ex load_ex = solu_loadfun(s, path);
+        if (!load_ex.is_ok)
+            return smc_proto_ex_err(sf_str_fmt("%s", solu_err_string(load_ex.err)));
+        return smc_proto_ex_ok(load_ex.ok);
+    }
+
+    smc_cache_key key;
+    char *cpath = smc_cache_path(cache_dir, path, &key);
+    if (cpath && smc_cache_fresh(cpath, &key) && sf_file_exists(sf_ref(cpath))) {
+        solu_load_ex load_ex = solu_loadfun(s, cpath);
+        if (load_ex.is_ok) {
+            free(cpath);
+            return smc_proto_ex_ok(load_ex.ok);
+        }
+        remove(cpath); // Unreadable, most likely written by another solus build
+    }
+
+    solu_compile_ex comp_ex = solu_cfile(s, path);
+    if (!comp_ex.is_ok) {
+        free(cpath);
+        char *trace = solu_ctrace_print(path, comp_ex.err, 15, 2, 1);
+        sf_str e = sf_str_fmt("%s", trace ? trace : "???");
+        free(trace);
+        return smc_proto_ex_err(e);
+    }
+
+    if (cpath) {
+        // The old stamp goes first and the bytecode is written aside and
+        // renamed, so a crash never leaves a torn or mislabeled entry
+        char *kpath = sf_str_fmt("%s.key", cpath).c_str;
+        remove(kpath);
+        free(kpath);
+        char *tmp = sf_str_fmt("%s.tmp", cpath).c_str;
+        bool dumped = solu_dumpfun(s, &comp_ex.ok, tmp);
+        if (dumped) remove(cpath); // rename won't replace an existing file on Windows
+        if (!dumped || rename(tmp, cpath) != 0 || !smc_cache_stamp(cpath, &key)) {
+            smc_err("Failed to cache bytecode for %s", path);
+            remove(tmp);
+        }
+        free(tmp);
+        free(cpath);
+    }
+    return smc_proto_ex_ok(comp_ex.ok);
+}
+
+// animations = { { name = 'walk', frames = {0, 1, 2}, fps = 8, loop = 'pingpong' }, ... }
+// where 'range = {first, last}' may stand in for frames and loop is
+// 'loop', 'once' or 'pingpong'
+static sf_str smc_open_anims(smc_spritedata *spr, solu_val anims, char *name) {
+    solu_dobj *a_obj = anims.dyn;
+    if (!solu_isdtype(anims, SOLU_DOBJ) || !a_obj->array.count)
+        return sf_str_fmt("Expected sprite '%s' animations:obj[>0]", name);
+    spr->anims = calloc(a_obj->array.count, sizeof(smc_anim));
+    for (uint32_t i = 0; i < a_obj->array.count; ++i) {
+        solu_val def = a_obj->array.data[i];
+        solu_val key = solu_isdtype(def, SOLU_DOBJ) ? solu_dobj_strget(def.dyn, "name") : SOLU_NIL;
+        if (!solu_isdtype(key, SOLU_DSTR))
+            return sf_str_fmt("Expected sprite '%s' animations[%u]:obj with name:str", name, i);
+        char *an = key.dyn;
+
+        smc_anim a = {.fps = 10, .mode = SMC_ANIM_LOOP};
+        solu_val frames = solu_dobj_strget(def.dyn, "frames");
+        solu_val range = solu_dobj_strget(def.dyn, "range");
+        if (solu_isdtype(frames, SOLU_DOBJ) && ((solu_dobj *)frames.dyn)->array.count) {
+            solu_dobj *f_obj = frames.dyn;
+            a.frames = malloc(f_obj->array.count * sizeof(uint32_t));
+            a.frame_c = f_obj->array.count;
+            for (uint32_t j = 0; j < f_obj->array.count; ++j) {
+                solu_val f = f_obj->array.data[j];
+                if (f.tt != SOLU_TI64 || f.i64 < 0 || f.i64 >= spr->frame_c) {
+                    free(a.frames);
+                    return sf_str_fmt("Sprite '%s' animations.%s.frames[%u] is not a frame", name, an, j);
+                }
+                a.frames[j] = (uint32_t)f.i64;
+            }
+        } else if (solu_arrptype(range, SOLU_TI64, 2)) {
+            solu_i64 first = ((solu_dobj *)range.dyn)->array.data[0].i64;
+            solu_i64 last = ((solu_dobj *)range.dyn)->array.data[1].i64;
+            if (first < 0 || last < first || last >= spr->frame_c)
+                return sf_str_fmt("Sprite '%s' animations.%s.range is out of bounds", name, an);
+            a.frame_c = (uint32_t)(last - first + 1);
+            a.frames = malloc(a.frame_c * sizeof(uint32_t));
+            for (uint32_t j = 0; j < a.frame_c; ++j)
+                a.frames[j] = (uint32_t)first + j;
+        } else return sf_str_fmt("Expected sprite '%s' animations.%s to contain frames:obj[>0] or range[2:i64]", name, an);
+
+        solu_val fps = solu_dobj_strget(def.dyn, "fps");
+        if (fps.tt == SOLU_TI64) a.fps = (float)fps.i64;
+        else if (fps.tt == SOLU_TF64) a.fps = (float)fps.f64;
+        solu_val loop = solu_dobj_strget(def.dyn, "loop");
+        if (loop.tt == SOLU_TBOOL) a.mode = loop.boolean ? SMC_ANIM_LOOP : SMC_ANIM_ONCE;
+        else if (solu_isdtype(loop, SOLU_DSTR)) {
+            if (strcmp(loop.dyn, "once") == 0) a.mode = SMC_ANIM_ONCE;
+            else if (strcmp(loop.dyn, "pingpong") == 0) a.mode = SMC_ANIM_PINGPONG;
+            else if (strcmp(loop.dyn, "loop") != 0) {
+                free(a.frames);
+                return sf_str_fmt("Sprite '%s' animations.%s.loop expected loop|once|pingpong", name, an);
+            }
+        }
+        if (!(a.fps > 0)) {
+            free(a.frames);
+            return sf_str_fmt("Sprite '%s' animations.%s.fps must be positive", name, an);
+        }
+        a.name = sf_str_cdup(an);
+        spr->anims[spr->anim_c++] = a;
+    }
+    return (sf_str){0};
+}
+
+smc_spr_ex smc_open_sprite(smc_renderer *ren, smc_atlas *atlas, solu_state *s, sf_str cache_dir, sf_str spr_dir, char *name) {
     char *fpath = sf_str_fmt("%s/%s", spr_dir.c_str, name).c_str;
     char *rpath = solu_findfile(s, fpath);
     free(fpath);
@@ -32,32 +194,17 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
         return smc_spr_ex_err(sf_str_fmt("Failed to load sprite '%s'", name));
     fpath = rpath;
 
-    solu_fproto fp;
-    if (smc_is_solc(fpath)) {
-        solu_load_ex load_ex = solu_loadfun(s, fpath);
-        if (!load_ex.is_ok) {
-            free(fpath);
-            return smc_spr_ex_err(sf_str_fmt(
-                "Failed to compile sprite '%s': %s",
-                name, solu_err_string(load_ex.err)
-            ));
-        }
-        fp = load_ex.ok;
-    } else {
-        solu_compile_ex comp_ex = solu_cfile(s, fpath);
-        if (!comp_ex.is_ok) {
-            char *trace = solu_ctrace_print(fpath, comp_ex.err, 15, 2, 1);
-            free(fpath);
-            smc_spr_ex ex = smc_spr_ex_err(sf_str_fmt(
-                "Failed to compile sprite '%s': %s",
-                name, trace
-            ));
-            free(trace);
-            return ex;
-        }
-        fp = comp_ex.ok;
-    }
+    smc_proto_ex comp_ex = smc_compile(s, cache_dir, fpath);
     free(fpath);
+    if (!comp_ex.is_ok) {
+        smc_spr_ex ex = smc_spr_ex_err(sf_str_fmt(
+            "Failed to compile sprite '%s': %s",
+            name, comp_ex.err.c_str
+        ));
+        sf_str_free(comp_ex.err);
+        return ex;
+    }
+    solu_fproto fp = comp_ex.ok;
 
     solu_call_ex call_ex = solu_call(s, &fp, NULL, 0);
     solu_fproto_free(&fp);
@@ -90,31 +237,21 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
     if (!spath)
         return smc_spr_ex_err(sf_str_fmt("Failed to find sprite '%s' source sprite '%s'", name, source.dyn));
 
-    SDL_Texture *texture = IMG_LoadTexture(ren, spath);
+    SDL_Surface *surface = IMG_Load(spath);
     free(spath);
-    if (!texture) return smc_spr_ex_err(sf_str_fmt(
+    if (!surface) return smc_spr_ex_err(sf_str_fmt(
         "Failed to load sprite '%s' source sprite '%s': %s",
         name,
         (char *)source.dyn,
         IMG_GetError()
     ));
-    SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
-
-    uint32_t format;
-    int access, w, h;
-    if (SDL_QueryTexture(texture, &format, &access, &w, &h) != 0) {
-        SDL_DestroyTexture(texture);
-        return smc_spr_ex_err(sf_str_fmt(
-            "Failed to query sprite '%s': %s",
-            name,
-            SDL_GetError()
-        ));
-    }
+    int w = surface->w, h = surface->h;
 
+    // Frames and animations are validated before packing, an atlas region can't be handed back
     smc_spritedata spr = {
-        .texture = texture,
         .size = {(uint32_t)w, (uint32_t)h},
     };
+    sf_str err = {0};
 
     if (solu_isdtype(frames, SOLU_DOBJ)) {
         spr.frames = malloc(f_obj->array.count * sizeof(smc_rect));
@@ -123,8 +260,8 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
         for (uint32_t i = 0; i < f_obj->array.count; ++i) {
             solu_val frame = f_obj->array.data[i];
             if (!solu_isdtype(frame, SOLU_DOBJ)) {
-                free(spr.frames);
-                return smc_spr_ex_err(sf_str_fmt("Expected sprite '%s' frames[%u]:obj[4:i64]", name, i));
+                err = sf_str_fmt("Expected sprite '%s' frames[%u]:obj[4:i64]", name, i);
+                goto fail;
             }
             solu_dobj *obj = frame.dyn;
             if (obj->array.count < 4 ||
@@ -132,16 +269,16 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
                 obj->array.data[1].tt != SOLU_TI64 ||
                 obj->array.data[2].tt != SOLU_TI64 ||
                 obj->array.data[3].tt != SOLU_TI64) {
-                free(spr.frames);
-                return smc_spr_ex_err(sf_str_fmt("Expected sprite '%s' frames[%u]:obj[4:i64]", name, i));
+                err = sf_str_fmt("Expected sprite '%s' frames[%u]:obj[4:i64]", name, i);
+                goto fail;
             }
             solu_val origin = solu_dobj_strget(obj, "origin");
             smc_point og = {0, 0};
             if (solu_isdtype(origin, SOLU_DOBJ)) {
                 solu_dobj *oo = origin.dyn;
                 if (oo->array.count < 2 || oo->array.data[0].tt != SOLU_TI64 || oo->array.data[1].tt != SOLU_TI64) {
-                    free(spr.frames);
-                    return smc_spr_ex_err(sf_str_fmt("Expected sprite '%s' frames[%u]:obj:origin[2:i64]", name, i));
+                    err = sf_str_fmt("Expected sprite '%s' frames[%u]:obj:origin[2:i64]", name, i);
+                    goto fail;
                 }
                 og = (smc_point){(int32_t)oo->array.data[0].i64, (int32_t)oo->array.data[1].i64};
             }
@@ -165,8 +302,10 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
         solu_val rect = solu_dobj_strget(a_obj, "rect");
         f_obj = rect.dyn;
         if (!solu_isdtype(rect, SOLU_DOBJ) || f_obj->array.count < 2 ||
-            f_obj->array.data[0].tt != SOLU_TI64 || f_obj->array.data[1].tt != SOLU_TI64)
-            return smc_spr_ex_err(sf_str_fmt("Expected sprite '%s' auto.rect[2:i64]", name));
+            f_obj->array.data[0].tt != SOLU_TI64 || f_obj->array.data[1].tt != SOLU_TI64) {
+            err = sf_str_fmt("Expected sprite '%s' auto.rect[2:i64]", name);
+            goto fail;
+        }
 
         smc_point origin = {0, 0};
         solu_val og = solu_dobj_strget(a_obj, "origin");
@@ -181,23 +320,29 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
 
         int fw = (int)(min(max(f_obj->array.data[0].i64, INT_MIN), INT_MAX));
         int fh = (int)(min(max(f_obj->array.data[1].i64, INT_MIN), INT_MAX));
-        if (fw <= 0 || w % fw)
-            return smc_spr_ex_err(sf_str_fmt(
+        if (fw <= 0 || w % fw) {
+            err = sf_str_fmt(
                 "Sprite '%s' auto.frame_size[0]: width %d does not fit in %d",
                 name, fw, w
-            ));
-        if (fh <= 0 || h % fh)
-            return smc_spr_ex_err(sf_str_fmt(
+            );
+            goto fail;
+        }
+        if (fh <= 0 || h % fh) {
+            err = sf_str_fmt(
                 "Sprite '%s' auto.frame_size[1]: height %d does not fit in %d",
                 name, fh, h
-            ));
+            );
+            goto fail;
+        }
 
         int col = w / fw;
         int row = h / fh;
 
         solu_val exclude = solu_dobj_strget(a_obj, "exclude");
-        if (exclude.tt == SOLU_TI64 && (exclude.i64 > col || exclude.i64 < 0))
-            return smc_spr_ex_err(sf_str_fmt( "Sprite '%s' auto.exclude: exclude must be 0<=e<=%d", col));
+        if (exclude.tt == SOLU_TI64 && (exclude.i64 > col || exclude.i64 < 0)) {
+            err = sf_str_fmt("Sprite '%s' auto.exclude: exclude must be 0<=e<=%d", name, col);
+            goto fail;
+        }
         int exc = exclude.tt == SOLU_TI64 ? (int)exclude.i64 : 0;
 
         solu_val _repeat = solu_dobj_strget(a_obj, "repeat");
@@ -222,9 +367,33 @@ smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *s, sf_str spr_dir, cha
         }
     }
 
+    solu_val anims = solu_dobj_strget(call_ex.ok.dyn, "animations");
+    if (anims.tt != SOLU_TNIL && (err = smc_open_anims(&spr, anims, name)).c_str)
+        goto fail;
+
+    // Uploaded by the renderer on first draw, headless only needs the size
+    SDL_Point at = {0, 0};
+    if (!ren->active) SDL_FreeSurface(surface);
+    else if (atlas && smc_atlas_add(atlas, ren, surface, &spr.texture, &at)) spr.atlased = true;
+    else if (!(spr.texture = smc_texture_new(surface))) {
+        err = sf_str_fmt("Failed to allocate sprite '%s'", name);
+        goto fail;
+    }
+    surface = NULL;
+
+    for (uint32_t i = 0; i < spr.frame_c; ++i) {
+        spr.frames[i].x += (uint32_t)at.x;
+        spr.frames[i].y += (uint32_t)at.y;
+    }
+
     smc_info("Loaded sprite '%s'.", name);
     spr.name = sf_str_cdup(name);
     return smc_spr_ex_ok(spr);
+
+fail:
+    if (surface) SDL_FreeSurface(surface);
+    smc_spritedata_free(ren, spr);
+    return smc_spr_ex_err(err);
 }
 
 smc_snd_ex smc_open_sound(solu_state *s, sf_str snd_dir, char *name) {
@@ -245,7 +414,7 @@ smc_snd_ex smc_open_sound(solu_state *s, sf_str snd_dir, char *name) {
     });
 }
 
-smc_snd_ex smc_open_music(solu_state *s, sf_str snd_dir, char *name) {
+smc_snd_ex smc_open_music(solu_state *s, sf_str cache_dir, sf_str snd_dir, char *name) {
     char *fpath = sf_str_fmt("%s/%s", snd_dir.c_str, name).c_str;
     char *rpath = solu_findfile(s, fpath);
     free(fpath);
@@ -253,32 +422,17 @@ smc_snd_ex smc_open_music(solu_state *s, sf_str snd_dir, char *name) {
         return smc_snd_ex_err(sf_str_fmt("Failed to load music '%s'", name));
     fpath = rpath;
 
-    solu_fproto fp;
-    if (smc_is_solc(fpath)) {
-        solu_load_ex load_ex = solu_loadfun(s, fpath);
-        if (!load_ex.is_ok) {
-            free(fpath);
-            return smc_snd_ex_err(sf_str_fmt(
-                "Failed to compile music '%s': %s",
-                name, solu_err_string(load_ex.err)
-            ));
-        }
-        fp = load_ex.ok;
-    } else {
-        solu_compile_ex comp_ex = solu_cfile(s, fpath);
-        if (!comp_ex.is_ok) {
-            char *trace = solu_ctrace_print(fpath, comp_ex.err, 15, 2, 1);
-            free(fpath);
-            smc_snd_ex ex = smc_snd_ex_err(sf_str_fmt(
-                "Failed to compile music '%s': %s",
-                name, trace
-            ));
-            free(trace);
-            return ex;
-        }
-        fp = comp_ex.ok;
-    }
+    smc_proto_ex comp_ex = smc_compile(s, cache_dir, fpath);
     free(fpath);
+    if (!comp_ex.is_ok) {
+        smc_snd_ex ex = smc_snd_ex_err(sf_str_fmt(
+            "Failed to compile music '%s': %s",
+            name, comp_ex.err.c_str
+        ));
+        sf_str_free(comp_ex.err);
+        return ex;
+    }
+    solu_fproto fp = comp_ex.ok;
 
     solu_call_ex call_ex = solu_call(s, &fp, NULL, 0);
     solu_fproto_free(&fp);
@@ -1,6 +1,8 @@
 #ifndef ASSET_H
 #define ASSET_H
 
+#include "atlas.h"
+#include "render.h"
 #include <solus/api.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
@@ -33,18 +35,47 @@ typedef struct {
     solu_f64 width, height;
 } smc_frect;
 
+typedef enum {
+    SMC_ANIM_LOOP,
+    SMC_ANIM_ONCE,
+    SMC_ANIM_PINGPONG,
+} smc_anim_mode;
+
+// Named run of frame indices from a sprite's 'animations' table
+typedef struct {
+    sf_str name;
+    uint32_t *frames;
+    uint32_t frame_c;
+    float fps;
+    smc_anim_mode mode;
+} smc_anim;
+
 typedef struct {
     void *g;
     sf_str name;
-    SDL_Texture *texture;
+    smc_texture *texture;
     smc_size size;
     smc_rect *frames;
     uint32_t frame_c;
+    smc_anim *anims;
+    uint32_t anim_c;
+    bool atlased; // Texture is a shared atlas page
 } smc_spritedata;
-static inline void smc_spritedata_free(smc_spritedata sprite) {
+static inline void smc_spritedata_free(smc_renderer *ren, smc_spritedata sprite) {
     sf_str_free(sprite.name);
-    SDL_DestroyTexture(sprite.texture);
+    if (!sprite.atlased)
+        smc_texture_free(ren, sprite.texture);
     if (sprite.frames) free(sprite.frames);
+    for (uint32_t i = 0; i < sprite.anim_c; ++i) {
+        sf_str_free(sprite.anims[i].name);
+        free(sprite.anims[i].frames);
+    }
+    free(sprite.anims);
+}
+static inline int smc_spritedata_anim(const smc_spritedata *sprite, const char *name) {
+    for (uint32_t i = 0; i < sprite->anim_c; ++i)
+        if (strcmp(sprite->anims[i].name.c_str, name) == 0) return (int)i;
+    return -1;
 }
 
 typedef struct {
@@ -80,18 +111,26 @@ void _smc_sprites_cleanup(smc_sprites *);
 #define KCLEANUP sf_str_free
 #include <sf/containers/map.h>
 
+#define EXPECTED_NAME smc_proto_ex
+#define EXPECTED_O solu_fproto
+#define EXPECTED_E sf_str
+#include <sf/containers/expected.h>
+// Loads .solc as is, .solu goes through the bytecode cache when cache_dir is set
+smc_proto_ex smc_compile(solu_state *state, sf_str cache_dir, char *path);
+
 #define EXPECTED_NAME smc_spr_ex
 #define EXPECTED_O smc_spritedata
 #define EXPECTED_E sf_str
 #include <sf/containers/expected.h>
-smc_spr_ex smc_open_sprite(SDL_Renderer *ren, solu_state *state, sf_str spr_dir, char *name);
+// Packed into 'atlas' when it has room, frames are then atlas coordinates
+smc_spr_ex smc_open_sprite(smc_renderer *ren, smc_atlas *atlas, solu_state *state, sf_str cache_dir, sf_str spr_dir, char *name);
 
 #define EXPECTED_NAME smc_snd_ex
 #define EXPECTED_O smc_sounddata
 #define EXPECTED_E sf_str
 #include <sf/containers/expected.h>
 smc_snd_ex smc_open_sound(solu_state *state, sf_str snd_dir, char *name);
-smc_snd_ex smc_open_music(solu_state *state, sf_str snd_dir, char *name);
+smc_snd_ex smc_open_music(solu_state *state, sf_str cache_dir, sf_str snd_dir, char *name);
 
 solu_val smc_manifest_load(solu_state *state);
 
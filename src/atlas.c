@@ -0,0 +1,157 @@
+#include "atlas.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Gutter on every side of an image, filled by repeating its edge texels so
+// rotated, scaled or sub-pixel quads sampling right at the border never pick
+// up a neighbour
+#define SMC_ATLAS_PAD 1
+
+// Lowest y a w*h rect can sit at when its left edge is on node i, -1 if it won't fit
+static int smc_skyline_fit(const smc_atlas_page *p, int size, uint32_t i, int w, int h) {
+    int x = p->nodes[i].x;
+    if (x + w > size) return -1;
+    int y = 0, left = w;
+    for (uint32_t j = i; left > 0; ++j) {
+        if (j == p->node_c) return -1;
+        if (p->nodes[j].y > y) y = p->nodes[j].y;
+        if (y + h > size) return -1;
+        left -= p->nodes[j].width;
+    }
+    return y;
+}
+
+static void smc_skyline_insert(smc_atlas_page *p, uint32_t i, int x, int y, int w) {
+    if (p->node_c == p->node_cap) {
+        uint32_t cap = p->node_cap * 2;
+        smc_skyline *nodes = realloc(p->nodes, cap * sizeof(smc_skyline));
+        if (!nodes) abort();
+        p->nodes = nodes;
+        p->node_cap = cap;
+    }
+    memmove(p->nodes + i + 1, p->nodes + i, (p->node_c - i) * sizeof(smc_skyline));
+    p->nodes[i] = (smc_skyline){x, y, w};
+    ++p->node_c;
+
+    // Trim what the new segment now covers, then merge equal heights
+    for (uint32_t j = i + 1; j < p->node_c;) {
+        smc_skyline *n = p->nodes + j;
+        int end = x + w;
+        if (n->x >= end) break;
+        int shrink = end - n->x;
+        if (shrink < n->width) {
+            n->x += shrink;
+            n->width -= shrink;
+            break;
+        }
+        memmove(n, n + 1, (p->node_c - j - 1) * sizeof(smc_skyline));
+        --p->node_c;
+    }
+    for (uint32_t j = 0; j + 1 < p->node_c;) {
+        if (p->nodes[j].y == p->nodes[j + 1].y) {
+            p->nodes[j].width += p->nodes[j + 1].width;
+            memmove(p->nodes + j + 1, p->nodes + j + 2, (p->node_c - j - 2) * sizeof(smc_skyline));
+            --p->node_c;
+        } else ++j;
+    }
+}
+
+// Bottom-left: lowest resulting top edge, then leftmost
+static bool smc_page_pack(smc_atlas_page *p, int size, int w, int h, SDL_Point *at) {
+    int best_y = -1, best_x = 0;
+    uint32_t best = 0;
+    for (uint32_t i = 0; i < p->node_c; ++i) {
+        int y = smc_skyline_fit(p, size, i, w, h);
+        if (y < 0) continue;
+        if (best_y < 0 || y < best_y || (y == best_y && p->nodes[i].x < best_x)) {
+            best_y = y;
+            best_x = p->nodes[i].x;
+            best = i;
+        }
+    }
+    if (best_y < 0) return false;
+    smc_skyline_insert(p, best, best_x, best_y + h, w);
+    *at = (SDL_Point){best_x, best_y};
+    return true;
+}
+
+// Pages are zeroed on creation, nothing is left to whatever the driver had
+static smc_atlas_page *smc_atlas_page_new(smc_atlas *a, smc_renderer *r) {
+    smc_atlas_page *pages = realloc(a->pages, (a->page_c + 1) * sizeof(smc_atlas_page));
+    if (!pages) abort();
+    a->pages = pages;
+    smc_atlas_page *p = a->pages + a->page_c;
+    *p = (smc_atlas_page){
+        .texture = smc_texture_page(a->size, a->size),
+        .nodes = malloc(16 * sizeof(smc_skyline)),
+        .node_cap = 16,
+    };
+    if (!p->texture || !p->nodes) abort();
+    p->nodes[0] = (smc_skyline){0, 0, a->size};
+    p->node_c = 1;
+    ++a->page_c;
+
+    SDL_Surface *blank = SDL_CreateRGBSurfaceWithFormat(0, a->size, a->size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!blank) abort();
+    SDL_FillRect(blank, NULL, 0);
+    smc_render_upload(r, p->texture, blank, (SDL_Point){0, 0});
+    return p;
+}
+
+// Converts to RGBA32 with the gutter added around the image
+static SDL_Surface *smc_atlas_extrude(SDL_Surface *surface) {
+    SDL_Surface *src = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!src) return NULL;
+    int w = src->w, h = src->h, pad = SMC_ATLAS_PAD;
+    SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, w + pad * 2, h + pad * 2, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!dst) {
+        SDL_FreeSurface(src);
+        return NULL;
+    }
+    for (int y = 0; y < dst->h; ++y) {
+        int sy = y < pad ? 0 : y >= h + pad ? h - 1 : y - pad;
+        const uint32_t *in = (const uint32_t *)((const uint8_t *)src->pixels + sy * src->pitch);
+        uint32_t *out = (uint32_t *)((uint8_t *)dst->pixels + y * dst->pitch);
+        for (int x = 0; x < pad; ++x) {
+            out[x] = in[0];
+            out[w + pad + x] = in[w - 1];
+        }
+        memcpy(out + pad, in, (size_t)w * sizeof(uint32_t));
+    }
+    SDL_FreeSurface(src);
+    return dst;
+}
+
+bool smc_atlas_add(smc_atlas *a, smc_renderer *r, SDL_Surface *surface, smc_texture **texture, SDL_Point *at) {
+    int w = surface->w + SMC_ATLAS_PAD * 2, h = surface->h + SMC_ATLAS_PAD * 2;
+    if (!a->size || w > a->size || h > a->size || !surface->w || !surface->h)
+        return false;
+
+    SDL_Surface *pixels = smc_atlas_extrude(surface);
+    if (!pixels) return false;
+
+    smc_atlas_page *page = NULL;
+    for (uint32_t i = 0; i < a->page_c && !page; ++i)
+        if (smc_page_pack(a->pages + i, a->size, w, h, at)) page = a->pages + i;
+    if (!page) {
+        page = smc_atlas_page_new(a, r);
+        smc_page_pack(page, a->size, w, h, at);
+    }
+
+    SDL_FreeSurface(surface);
+    smc_render_upload(r, page->texture, pixels, *at);
+    at->x += SMC_ATLAS_PAD;
+    at->y += SMC_ATLAS_PAD;
+    *texture = page->texture;
+    return true;
+}
+
+void smc_atlas_free(smc_atlas *a, smc_renderer *r) {
+    for (uint32_t i = 0; i < a->page_c; ++i) {
+        smc_texture_free(r, a->pages[i].texture);
+        free(a->pages[i].nodes);
+    }
+    free(a->pages);
+    a->pages = NULL;
+    a->page_c = 0;
+}
@@ -0,0 +1,31 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "render.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Skyline packer over square pages. Images are converted on the loading
+// thread and copied into a page by the renderer, regions are never reclaimed
+// so pages live as long as the game.
+typedef struct {
+    int x, y, width;
+} smc_skyline;
+
+typedef struct {
+    smc_texture *texture;
+    smc_skyline *nodes;
+    uint32_t node_c, node_cap;
+} smc_atlas_page;
+
+typedef struct {
+    smc_atlas_page *pages;
+    uint32_t page_c;
+    int size; // Page width and height, 0 disables packing
+} smc_atlas;
+
+// Takes the surface on success, 'at' is its top-left inside '*texture'
+bool smc_atlas_add(smc_atlas *a, smc_renderer *r, SDL_Surface *surface, smc_texture **texture, SDL_Point *at);
+void smc_atlas_free(smc_atlas *a, smc_renderer *r);
+
+#endif // ATLAS_H
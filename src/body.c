@@ -0,0 +1,90 @@
+#include "body.h"
+#include <math.h>
+#include <stdlib.h>
+
+const char *const SMC_BODY_FIELDS[SMC_BODY_FIELD_COUNT] = {
+    [SMC_BODY_X] = "x",
+    [SMC_BODY_Y] = "y",
+    [SMC_BODY_VX] = "vx",
+    [SMC_BODY_VY] = "vy",
+    [SMC_BODY_AX] = "ax",
+    [SMC_BODY_AY] = "ay",
+    [SMC_BODY_DRAG] = "drag",
+    [SMC_BODY_MAX_SPEED] = "max_speed",
+};
+
+uint32_t smc_bodies_add(smc_bodies *b, uint32_t owner) {
+    if (b->count == b->cap) {
+        uint32_t cap = b->cap ? b->cap * 2 : 64;
+        for (int f = 0; f < SMC_BODY_FIELD_COUNT; ++f) {
+            solu_f64 *col = realloc(b->fields[f], cap * sizeof(solu_f64));
+            if (!col) abort();
+            b->fields[f] = col;
+        }
+        uint32_t *owners = realloc(b->owners, cap * sizeof(uint32_t));
+        bool *moved = realloc(b->moved, cap * sizeof(bool));
+        if (!owners || !moved) abort();
+        b->owners = owners;
+        b->moved = moved;
+        b->cap = cap;
+    }
+    uint32_t i = b->count++;
+    for (int f = 0; f < SMC_BODY_FIELD_COUNT; ++f)
+        b->fields[f][i] = 0;
+    b->owners[i] = owner;
+    b->moved[i] = false;
+    return i;
+}
+
+// Returns the owner of the body now at 'i', or UINT32_MAX if it was the last
+uint32_t smc_bodies_remove(smc_bodies *b, uint32_t i) {
+    uint32_t last = --b->count;
+    if (i == last) return UINT32_MAX;
+    for (int f = 0; f < SMC_BODY_FIELD_COUNT; ++f)
+        b->fields[f][i] = b->fields[f][last];
+    b->owners[i] = b->owners[last];
+    b->moved[i] = b->moved[last];
+    return b->owners[i];
+}
+
+// Semi-implicit Euler: acceleration, then drag and the speed clamp, then position
+void smc_bodies_step(smc_bodies *b, solu_f64 dt) {
+    uint32_t n = b->count;
+    solu_f64 *restrict x = b->fields[SMC_BODY_X];
+    solu_f64 *restrict y = b->fields[SMC_BODY_Y];
+    solu_f64 *restrict vx = b->fields[SMC_BODY_VX];
+    solu_f64 *restrict vy = b->fields[SMC_BODY_VY];
+    const solu_f64 *restrict ax = b->fields[SMC_BODY_AX];
+    const solu_f64 *restrict ay = b->fields[SMC_BODY_AY];
+    const solu_f64 *restrict drag = b->fields[SMC_BODY_DRAG];
+    const solu_f64 *restrict max_speed = b->fields[SMC_BODY_MAX_SPEED];
+    bool *restrict moved = b->moved;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        moved[i] |= vx[i] != 0 || vy[i] != 0; // Coming to rest still needs writing back
+        solu_f64 keep = 1 - drag[i] * dt;
+        keep = keep < 0 ? 0 : keep;
+        vx[i] = (vx[i] + ax[i] * dt) * keep;
+        vy[i] = (vy[i] + ay[i] * dt) * keep;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        solu_f64 sq = vx[i] * vx[i] + vy[i] * vy[i];
+        solu_f64 cap = max_speed[i] * max_speed[i];
+        solu_f64 scale = max_speed[i] > 0 && sq > cap ? max_speed[i] / sqrt(sq) : 1;
+        vx[i] *= scale;
+        vy[i] *= scale;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        moved[i] |= vx[i] != 0 || vy[i] != 0;
+    }
+}
+
+void smc_bodies_free(smc_bodies *b) {
+    for (int f = 0; f < SMC_BODY_FIELD_COUNT; ++f)
+        free(b->fields[f]);
+    free(b->owners);
+    free(b->moved);
+    *b = (smc_bodies){0};
+}
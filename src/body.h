@@ -0,0 +1,37 @@
+#ifndef BODY_H
+#define BODY_H
+
+#include <solus/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Kinematic state mirrored from object fields of the same name
+typedef enum {
+    SMC_BODY_X,
+    SMC_BODY_Y,
+    SMC_BODY_VX,
+    SMC_BODY_VY,
+    SMC_BODY_AX,
+    SMC_BODY_AY,
+    SMC_BODY_DRAG,      // Fraction of velocity lost per second
+    SMC_BODY_MAX_SPEED, // 0 leaves speed unclamped
+    SMC_BODY_FIELD_COUNT,
+} smc_body_field;
+
+extern const char *const SMC_BODY_FIELDS[SMC_BODY_FIELD_COUNT];
+
+// Structure of arrays, one packed column per field so integration runs as
+// straight loops the compiler can vectorize. Removal swaps the last body in.
+typedef struct {
+    solu_f64 *fields[SMC_BODY_FIELD_COUNT];
+    uint32_t *owners; // Object slot per body
+    bool *moved;      // Set by integration until written back
+    uint32_t count, cap;
+} smc_bodies;
+
+uint32_t smc_bodies_add(smc_bodies *b, uint32_t owner);
+uint32_t smc_bodies_remove(smc_bodies *b, uint32_t i);
+void smc_bodies_step(smc_bodies *b, solu_f64 dt);
+void smc_bodies_free(smc_bodies *b);
+
+#endif // BODY_H
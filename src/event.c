@@ -0,0 +1,188 @@
+#include "event.h"
+#include <stdlib.h>
+
+smc_bus smc_bus_new(void) {
+    return (smc_bus){.names = smc_channels_new()};
+}
+
+static void smc_eventq_release(smc_eventq *q) {
+    for (uint32_t i = 0; i < q->count; ++i)
+        solu_drelease(q->data[i].payload);
+    q->count = 0;
+}
+
+void smc_bus_free(smc_bus *bus) {
+    for (uint32_t i = 0; i < bus->sub_c; ++i)
+        if (bus->subs[i].active)
+            solu_drelease(bus->subs[i].fn);
+    for (uint32_t i = 0; i < bus->channel_c; ++i) {
+        sf_str_free(bus->channels[i].name);
+        free(bus->channels[i].subs);
+    }
+    smc_eventq_release(&bus->queue);
+    smc_eventq_release(&bus->dispatch);
+    free(bus->queue.data);
+    free(bus->dispatch.data);
+    free(bus->channels);
+    free(bus->subs);
+    smc_channels_free(&bus->names);
+    *bus = (smc_bus){0};
+}
+
+static uint32_t smc_bus_channel(smc_bus *bus, sf_str name) {
+    smc_channels_ex found = smc_channels_get(&bus->names, name);
+    if (found.is_ok) return found.ok;
+
+    if (bus->channel_c == bus->channel_cap) {
+        uint32_t cap = bus->channel_cap ? bus->channel_cap * 2 : 16;
+        smc_channel *channels = realloc(bus->channels, cap * sizeof(smc_channel));
+        if (!channels) abort();
+        bus->channels = channels;
+        bus->channel_cap = cap;
+    }
+    bus->channels[bus->channel_c] = (smc_channel){.name = sf_str_cdup(name.c_str)};
+    smc_channels_set(&bus->names, sf_str_cdup(name.c_str), bus->channel_c);
+    return bus->channel_c++;
+}
+
+smc_sub *smc_bus_get(smc_bus *bus, solu_i64 handle) {
+    uint32_t i = (uint32_t)((uint64_t)handle & UINT32_MAX);
+    uint32_t gen = (uint32_t)((uint64_t)handle >> 32);
+    if (i >= bus->sub_c) return NULL;
+    smc_sub *sub = bus->subs + i;
+    return sub->active && sub->gen == gen ? sub : NULL;
+}
+
+solu_i64 smc_bus_on(smc_bus *bus, sf_str name, solu_val fn, solu_i64 owner, uint32_t *owned) {
+    uint32_t channel = smc_bus_channel(bus, name);
+    uint32_t i;
+    if (bus->free_head) {
+        i = bus->free_head - 1;
+        bus->free_head = bus->subs[i].owned_next;
+    } else {
+        if (bus->sub_c == bus->sub_cap) {
+            uint32_t cap = bus->sub_cap ? bus->sub_cap * 2 : 64;
+            smc_sub *subs = realloc(bus->subs, cap * sizeof(smc_sub));
+            if (!subs) abort();
+            bus->subs = subs;
+            bus->sub_cap = cap;
+        }
+        i = bus->sub_c++;
+        bus->subs[i] = (smc_sub){.gen = 1};
+    }
+
+    smc_channel *c = bus->channels + channel;
+    if (c->count == c->cap) {
+        uint32_t cap = c->cap ? c->cap * 2 : 8;
+        uint32_t *subs = realloc(c->subs, cap * sizeof(uint32_t));
+        if (!subs) abort();
+        c->subs = subs;
+        c->cap = cap;
+    }
+    c->subs[c->count++] = i;
+
+    smc_sub *sub = bus->subs + i;
+    sub->fn = fn;
+    sub->owner = owner;
+    sub->channel = channel;
+    sub->slot = c->count;
+    sub->active = true;
+    sub->owned_prev = 0;
+    sub->owned_next = 0;
+    if (owned) {
+        sub->owned_next = *owned;
+        if (*owned) bus->subs[*owned - 1].owned_prev = i + 1;
+        *owned = i + 1;
+    }
+    solu_dhold(fn);
+    return (solu_i64)(((uint64_t)sub->gen << 32) | i);
+}
+
+static void smc_bus_release(smc_bus *bus, uint32_t i) {
+    smc_sub *sub = bus->subs + i;
+    smc_channel *c = bus->channels + sub->channel;
+    c->subs[sub->slot - 1] = SMC_SUB_DEAD;
+    ++c->dead;
+    solu_drelease(sub->fn);
+    *sub = (smc_sub){.gen = sub->gen + 1, .owned_next = bus->free_head};
+    bus->free_head = i + 1;
+}
+
+void smc_bus_off(smc_bus *bus, solu_i64 handle, uint32_t *owned) {
+    smc_sub *sub = smc_bus_get(bus, handle);
+    if (!sub) return;
+    if (sub->owned_prev) bus->subs[sub->owned_prev - 1].owned_next = sub->owned_next;
+    else if (owned) *owned = sub->owned_next;
+    if (sub->owned_next) bus->subs[sub->owned_next - 1].owned_prev = sub->owned_prev;
+    smc_bus_release(bus, (uint32_t)(sub - bus->subs));
+}
+
+void smc_bus_drop(smc_bus *bus, uint32_t *owned) {
+    uint32_t next = *owned;
+    *owned = 0;
+    while (next) {
+        uint32_t i = next - 1;
+        next = bus->subs[i].owned_next;
+        smc_bus_release(bus, i);
+    }
+}
+
+void smc_bus_emit(smc_bus *bus, sf_str name, solu_val payload) {
+    // Nobody has ever listened, don't bother queueing
+    smc_channels_ex found = smc_channels_get(&bus->names, name);
+    if (!found.is_ok) return;
+    smc_channel *c = bus->channels + found.ok;
+    if (c->count == c->dead) return;
+
+    smc_eventq *q = &bus->queue;
+    if (q->count == q->cap) {
+        uint32_t cap = q->cap ? q->cap * 2 : 64;
+        smc_event *data = realloc(q->data, cap * sizeof(smc_event));
+        if (!data) abort();
+        q->data = data;
+        q->cap = cap;
+    }
+    q->data[q->count++] = (smc_event){found.ok, payload};
+    solu_dhold(payload);
+}
+
+static void smc_channel_compact(smc_bus *bus, smc_channel *c) {
+    if (!c->dead) return;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < c->count; ++i) {
+        uint32_t sub = c->subs[i];
+        if (sub == SMC_SUB_DEAD) continue;
+        c->subs[n++] = sub;
+        bus->subs[sub].slot = n;
+    }
+    c->count = n;
+    c->dead = 0;
+}
+
+void smc_bus_flush(smc_bus *bus, smc_bus_fire fire, void *ud) {
+    if (!bus->queue.count || bus->dispatch.count) return; // Already flushing
+
+    smc_eventq q = bus->queue;
+    bus->queue = bus->dispatch;
+    bus->dispatch = q;
+
+    for (uint32_t e = 0; e < bus->dispatch.count; ++e) {
+        smc_event ev = bus->dispatch.data[e];
+        smc_channel *c = bus->channels + ev.channel;
+        smc_channel_compact(bus, c);
+
+        // Subscribers added by a handler hear the next event, not this one
+        uint32_t count = c->count;
+        for (uint32_t i = 0; i < count; ++i) {
+            c = bus->channels + ev.channel;
+            uint32_t s = c->subs[i];
+            if (s == SMC_SUB_DEAD) continue;
+            smc_sub *sub = bus->subs + s;
+            solu_val fn = sub->fn;
+            solu_dhold(fn);
+            fire(ud, c->name.c_str, fn, sub->owner, ev.payload);
+            solu_drelease(fn);
+        }
+    }
+    smc_eventq_release(&bus->dispatch);
+}
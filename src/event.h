@@ -0,0 +1,69 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <solus/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAP_NAME smc_channels
+#define MAP_K sf_str
+#define MAP_V uint32_t
+#define EQUAL_FN(s1, s2) (sf_str_eq(s1, s2))
+#define HASH_FN(s) (sf_str_hash(s))
+#define KCLEANUP sf_str_free
+#include <sf/containers/map.h>
+
+// Links are indices + 1 so zero ends a chain, 'owned_next' doubles as the
+// free list. Subscriptions of one owner are chained so they drop together.
+typedef struct {
+    solu_val fn;
+    solu_i64 owner;
+    uint32_t channel, slot, gen;
+    uint32_t owned_next, owned_prev;
+    bool active;
+} smc_sub;
+
+// Subscribers in subscription order, removals leave a tombstone that is swept
+// out before the channel next dispatches
+#define SMC_SUB_DEAD UINT32_MAX
+typedef struct {
+    sf_str name;
+    uint32_t *subs;
+    uint32_t count, cap, dead;
+} smc_channel;
+
+typedef struct {
+    uint32_t channel;
+    solu_val payload;
+} smc_event;
+
+typedef struct {
+    smc_event *data;
+    uint32_t count, cap;
+} smc_eventq;
+
+// Emitted events queue up and are dispatched in batches by smc_bus_flush,
+// anything emitted by a handler waits for the next flush
+typedef struct {
+    smc_channels names;
+    smc_channel *channels;
+    uint32_t channel_c, channel_cap;
+    smc_sub *subs;
+    uint32_t sub_c, sub_cap, free_head;
+    smc_eventq queue, dispatch;
+} smc_bus;
+
+typedef void (*smc_bus_fire)(void *ud, const char *name, solu_val fn, solu_i64 owner, solu_val payload);
+
+smc_bus smc_bus_new(void);
+void smc_bus_free(smc_bus *bus);
+
+solu_i64 smc_bus_on(smc_bus *bus, sf_str name, solu_val fn, solu_i64 owner, uint32_t *owned);
+smc_sub *smc_bus_get(smc_bus *bus, solu_i64 handle);
+void smc_bus_off(smc_bus *bus, solu_i64 handle, uint32_t *owned);
+void smc_bus_drop(smc_bus *bus, uint32_t *owned);
+
+void smc_bus_emit(smc_bus *bus, sf_str name, solu_val payload);
+void smc_bus_flush(smc_bus *bus, smc_bus_fire fire, void *ud);
+
+#endif // EVENT_H
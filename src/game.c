@@ -1,7 +1,9 @@
 #include "game.h"
 #include "asset.h"
 #include "api.h"
+#include "object.h"
 #include <inttypes.h>
+#include <math.h>
 #include "sf/fs.h"
 #include "sf/str.h"
 #include "solus/bytecode.h"
@@ -41,44 +43,39 @@ void _smc_sprites_cleanup(smc_sprites *spr) {
     smc_sprites_foreach(spr, _smc_sprites_fe, NULL);
 }
 
-static inline void smc_pause(smc_game *g, bool toggle) {
-    g->paused = toggle;
-    solu_dobj_strset(g->ginfo.dyn, "paused", (solu_val){SOLU_TBOOL, .boolean=toggle});
-}
-
-bool smc_callmethod(smc_game *g, solu_dobj *obj, char *name) {
+bool smc_callfun(smc_game *g, solu_dobj *obj, solu_val fn, const char *name, solu_val *args, uint32_t argc) {
+    if (!solu_isdtype(fn, SOLU_DFUN))
+        return false;
     g->ocall = (solu_val){SOLU_TDYN, .dyn=obj};
-    solu_val update = solu_dobj_strget(obj, name);
-    solu_dhold(update);
-    if (solu_isdtype(update, SOLU_DFUN)) {
-        solu_call_ex call_ex = solu_call(g->s, update.dyn, NULL, 0);
-        if (!call_ex.is_ok) {
-            solu_val type = solu_dobj_strget(obj, "type");
-            char *trace = solu_trace_print(call_ex.err.trace, 5, 2, 1);
-            if (trace) {
-                smc_err(
-                    "Object %s:%s() error: %s\n" TUI_CLEAR "%s",
-                    solu_isdtype(type, SOLU_DSTR) ? (char *)type.dyn : "???", name,
-                    call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt),
-                    trace
-                );
-                free(trace);
-            } else smc_err(
-                TUI_ERR "Object %s:%s() error: %s\n" TUI_CLEAR,
+    solu_dhold(fn);
+    solu_call_ex call_ex = solu_call(g->s, fn.dyn, args, argc);
+    if (!call_ex.is_ok) {
+        solu_val type = solu_dobj_strget(obj, "type");
+        char *trace = solu_trace_print(call_ex.err.trace, 5, 2, 1);
+        if (trace) {
+            smc_err(
+                "Object %s:%s() error: %s\n" TUI_CLEAR "%s",
                 solu_isdtype(type, SOLU_DSTR) ? (char *)type.dyn : "???", name,
-                call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt)
+                call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt),
+                trace
             );
+            free(trace);
+        } else smc_err(
+            TUI_ERR "Object %s:%s() error: %s\n" TUI_CLEAR,
+            solu_isdtype(type, SOLU_DSTR) ? (char *)type.dyn : "???", name,
+            call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt)
+        );
 
-            if (g->err_pause)
-                smc_pause(g, true);
-        }
-        solu_drelease(update);
-        g->ocall = SOLU_NIL;
-        return true;
+        if (g->err_pause)
+            smc_pause(g, true);
     }
-    solu_drelease(update);
+    solu_drelease(fn);
     g->ocall = SOLU_NIL;
-    return false;
+    return true;
+}
+
+bool smc_callmethod(smc_game *g, solu_dobj *obj, char *name) {
+    return smc_callfun(g, obj, solu_dobj_strget(obj, name), name, NULL, 0);
 }
 
 int smc_changeroom(smc_game *g, char *name) {
@@ -98,25 +95,14 @@ int smc_changeroom(smc_game *g, char *name) {
         }
         path = rp;
 
-        solu_fproto fp;
-        if (smc_is_solc(path)) {
-            solu_load_ex load_ex = solu_loadfun(g->s, path);
-            if (!load_ex.is_ok) {
-                smc_err("Unable to load %s: %s", path, solu_err_string(load_ex.err));
-                free(path);
-                return -1;
-            }
-            fp = load_ex.ok;
-        } else {
-            solu_compile_ex comp_ex = solu_cfile(g->s, path);
-            if (!comp_ex.is_ok) {
-                char *trace = solu_ctrace_print(path, comp_ex.err, 15, 2, 1);
-                smc_err("Unable to load %s\n%s", trace);
-                free(path); free(trace);
-                return -1;
-            }
-            fp = comp_ex.ok;
+        smc_proto_ex comp_ex = smc_compile(g->s, g->cache_dir, path);
+        if (!comp_ex.is_ok) {
+            smc_err("Unable to load %s\n%s", path, comp_ex.err.c_str);
+            sf_str_free(comp_ex.err);
+            free(path);
+            return -1;
         }
+        solu_fproto fp = comp_ex.ok;
 
         solu_call_ex call_ex = solu_call(g->s, &fp, NULL, 0);
         solu_fproto_free(&fp);
@@ -177,31 +163,27 @@ int smc_changeroom(smc_game *g, char *name) {
     sf_str_free(g->room);
     g->room = sf_str_cdup(name);
     solu_dobj_strset(g->ginfo.dyn, "room", solu_dnstr(g->s, g->room.c_str));
-    smc_callmethods(g, g->objects.dyn, "cleanup");
+
+    // cleanup() may delete other objects, walk a copy of the live set
+    uint32_t live_c = g->live_c;
+    if (live_c) {
+        solu_i64 *ids = smc_arena_alloc(&g->arena, live_c * sizeof(solu_i64));
+        for (uint32_t i = 0; i < live_c; ++i)
+            ids[i] = smc_handle(g->live[i], g->records[g->live[i]].gen);
+        for (uint32_t i = 0; i < live_c; ++i) {
+            smc_object *o = smc_object_get(g, ids[i]);
+            if (o) smc_callmethod(g, o->obj.dyn, "cleanup");
+        }
+    }
+    smc_object_clear(g);
     solu_drelease(g->objects);
     g->objects = solu_dnew(g->s, SOLU_DOBJ);
     solu_setg(g->s, "objects", g->objects);
     solu_dhold(g->objects);
-    g->id_c = 0;
-
-    solu_dobj *obj = spawns.dyn;
-    solu_dhold(spawns);
-    for (solu_val *v = obj->array.data; v < obj->array.data + obj->array.count; ++v) {
-        if (!solu_isdtype(*v, SOLU_DOBJ))
-            continue;
-        solu_val type = solu_dobj_strget(v->dyn, "type");
-        if (!solu_isdtype(type, SOLU_DSTR))
-            continue;
 
-        solu_val obj = smc_object_new(g, g->id_c++, sf_ref(type.dyn));
-        if (solu_isdtype(obj, SOLU_DERR)) {
-            printf("%s\n", (char *)obj.dyn);
-            continue;
-        }
-        solu_dappend(obj, *v);
-        smc_callmethod(g, obj.dyn, "start");
-    }
-    solu_drelease(spawns);
+    if (smc_tilemap_load(g, room))
+        return -1;
+    smc_object_batch(g, (sf_str){0}, spawns, SOLU_NIL);
 
     solu_val start = solu_dobj_strget(room.dyn, "start");
     if (solu_isdtype(start, SOLU_DFUN)) {
@@ -219,7 +201,7 @@ int smc_changeroom(smc_game *g, char *name) {
     return 0;
 }
 
-smc_game *smc_game_new(void) {
+smc_game *smc_game_new(smc_options opts) {
     smc_game *game = malloc(sizeof(smc_game));
     solu_state *s = solu_state_new();
     solu_usestd(s);
@@ -230,10 +212,13 @@ smc_game *smc_game_new(void) {
         .objects = solu_dnew(s, SOLU_DOBJ),
         .rooms = solu_dnew(s, SOLU_DOBJ),
         .spr_cache = solu_valmap_new(),
+        .prototypes = smc_prototypes_new(),
+        .events = smc_bus_new(),
         .mus_cache = solu_valmap_new(),
         .load_cache = solu_dnew(s, SOLU_DOBJ),
         .clear_color = (SDL_Color){0, 0, 0, 0},
         .last_time = solu_timesec(),
+        .max_frames = opts.frames,
         .collision_data = {.partitions = NULL}
     };
     smc_platform_init(&game->platform);
@@ -275,8 +260,59 @@ smc_game *smc_game_new(void) {
     solu_val scale = solu_dobj_strget(window.dyn, "scale");
     scale = scale.tt != SOLU_TI64 ? (solu_val){SOLU_TI64, .i64=1} : scale;
     game->scale = scale.i64;
+
+    solu_val vsync = solu_dobj_strget(window.dyn, "vsync");
+    game->pacing.vsync = vsync.tt == SOLU_TBOOL ? vsync.boolean : true;
+    // SDL only supports its render API on the thread that owns the window and
+    // event pump. A render thread is an experimental build option, and even
+    // then refused where the backend is known to break: D3D, Metal, GXM here
+    // and GL on X11 once the window exists.
+    solu_val threaded = solu_dobj_strget(window.dyn, "render_thread");
+    bool render_thread = threaded.tt == SOLU_TBOOL && threaded.boolean;
+#if !defined(SMC_EXPERIMENTAL_RENDER_THREAD)
+    if (render_thread) {
+        smc_err("window.render_thread needs a build with SMC_EXPERIMENTAL_RENDER_THREAD, rendering on the main thread", NULL);
+        render_thread = false;
+    }
+#elif defined(_WIN32) || defined(__APPLE__) || defined(__vita__)
+    if (render_thread) {
+        smc_err("window.render_thread is not supported on %s, rendering on the main thread", smc_platform_string());
+        render_thread = false;
+    }
+#endif
+    solu_val fps = solu_dobj_strget(window.dyn, "fps");
+    solu_f64 target = fps.tt == SOLU_TI64 ? (solu_f64)fps.i64 : fps.tt == SOLU_TF64 ? fps.f64 : 0;
+    if (target > 0)
+        game->pacing.period = (uint64_t)((solu_f64)SDL_GetPerformanceFrequency() / target);
     solu_val err_pause = solu_dobj_strget(game->manifest.dyn, "err_pause");
     game->err_pause = err_pause.tt == SOLU_TBOOL ? err_pause.boolean : false;
+    solu_val budget = solu_dobj_strget(game->manifest.dyn, "job_budget");
+    solu_f64 budget_ms = budget.tt == SOLU_TI64 ? (solu_f64)budget.i64 : budget.tt == SOLU_TF64 ? budget.f64 : 2;
+    game->jobs.budget = budget_ms > 0 ? budget_ms / 1000 : 0;
+    // atlas = false loads every sprite into its own texture
+    solu_val atlas = solu_dobj_strget(game->manifest.dyn, "atlas");
+    game->atlas.size = atlas.tt == SOLU_TI64 ? (int)max(0, min(atlas.i64, 8192))
+        : atlas.tt == SOLU_TBOOL && !atlas.boolean ? 0 : 1024;
+    solu_val headless = solu_dobj_strget(game->manifest.dyn, "headless");
+    game->headless = opts.headless || (headless.tt == SOLU_TBOOL && headless.boolean);
+
+    // timestep = { rate = 60, max_steps = 5 }
+    solu_val timestep = solu_dobj_strget(game->manifest.dyn, "timestep");
+    if (solu_isdtype(timestep, SOLU_DOBJ)) {
+        solu_val rate = solu_dobj_strget(timestep.dyn, "rate");
+        solu_f64 hz = rate.tt == SOLU_TI64 ? (solu_f64)rate.i64 : rate.tt == SOLU_TF64 ? rate.f64 : 0;
+        if (hz <= 0) {
+            smc_err("Expected timestep.rate:i64|f64 > 0 in manifest.solu", NULL);
+            smc_game_free(game);
+            return NULL;
+        }
+        solu_val max_steps = solu_dobj_strget(timestep.dyn, "max_steps");
+        game->timestep = (smc_timestep){
+            .fixed = true,
+            .step = 1.0 / hz,
+            .max_steps = max_steps.tt == SOLU_TI64 ? (uint32_t)max(1, min(max_steps.i64, 64)) : 5,
+        };
+    }
 
     // solus value that stores a pointer to the game
     solu_val gptr = solu_dnusr(s,
@@ -298,8 +334,21 @@ smc_game *smc_game_new(void) {
     solu_dobj_strset(ginfo, "width", (solu_val){SOLU_TI64, .i64=(solu_i64)game->resolution.x});
     solu_dobj_strset(ginfo, "height", (solu_val){SOLU_TI64, .i64=(solu_i64)game->resolution.y});
     solu_dobj_strset(ginfo, "platform", solu_dnstr(s, smc_platform_string()));
+    solu_dobj_strset(ginfo, "headless", (solu_val){SOLU_TBOOL, .boolean = game->headless});
     solu_dobj_strset(ginfo, "paused", (solu_val){SOLU_TBOOL, .boolean = false});
+    solu_dobj_strset(ginfo, "delta_time", (solu_val){SOLU_TF64, .f64 = game->timestep.step});
+    solu_dobj_strset(ginfo, "alpha", (solu_val){SOLU_TF64, .f64 = 1});
+    solu_dobj_strset(ginfo, "fps", (solu_val){SOLU_TF64, .f64 = 0});
+    solu_dobj_strset(ginfo, "jitter", (solu_val){SOLU_TF64, .f64 = 0});
+    solu_dobj_strset(ginfo, "arena_peak", (solu_val){SOLU_TI64, .i64 = 0});
+    game->stats = solu_dnew(s, SOLU_DOBJ);
+    solu_dhold(game->stats);
+    solu_dobj_strset(ginfo, "stats", game->stats);
     solu_dobj_strset(ginfo, "quit", solu_wrapcfun(s, smc_quit, 0, &gptr, 1));
+    solu_dobj_strset(ginfo, "object", solu_wrapcfun(s, smc_get_object, 1, &gptr, 1));
+    solu_dobj_strset(ginfo, "after", solu_wrapcfun(s, smc_game_after, 2, &gptr, 1));
+    solu_dobj_strset(ginfo, "every", solu_wrapcfun(s, smc_game_every, 2, &gptr, 1));
+    solu_dobj_strset(ginfo, "defer", solu_wrapcfun(s, smc_game_defer, 1, &gptr, 1));
 
     // setter fields
     solu_val set = solu_dnew(s, SOLU_DOBJ);
@@ -352,6 +401,14 @@ smc_game *smc_game_new(void) {
     if (!p) { smc_game_free(game); return NULL; }
     game->snd_dir = sf_own(p);
 
+    // cache = false opts out of writing compiled scripts to disk, so does a
+    // cache dir that can't be created
+    solu_val cache = solu_dobj_strget(game->manifest.dyn, "cache");
+    if (cache.tt != SOLU_TBOOL || cache.boolean) {
+        p = smc_make_dir("cache");
+        if (p) game->cache_dir = sf_own(p);
+    }
+
     smc_info(
         "=============== Game Start ===============\n"
         "Loaded manifest for game '%s'.\n"
@@ -368,8 +425,21 @@ smc_game *smc_game_new(void) {
         game->scale,
         game->obj_dir.c_str, game->room_dir.c_str, game->spr_dir.c_str, game->snd_dir.c_str
     );
+    if (game->headless)
+        smc_info("Running headless: no window, renderer or audio device", NULL);
+    if (game->pacing.period)
+        smc_info(
+            "Frame limiter: %.2ffps, vsync %s",
+            (double)SDL_GetPerformanceFrequency() / (double)game->pacing.period,
+            game->pacing.vsync ? "on" : "off"
+        );
+    if (game->timestep.fixed)
+        smc_info("Fixed timestep: %.2fHz, max %u steps/frame", 1.0 / game->timestep.step, game->timestep.max_steps);
 
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
+    // Headless keeps the mixer API alive on top of SDL's null audio driver
+    if (game->headless)
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    if (SDL_Init(game->headless ? SDL_INIT_EVENTS | SDL_INIT_AUDIO : SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
         smc_err(TUI_ERR "SDL_Init Error: %s\n" TUI_CLEAR, SDL_GetError());
         return NULL;
     }
@@ -386,6 +456,10 @@ smc_game *smc_game_new(void) {
         return NULL;
     }
 
+    game->open = true;
+    if (game->headless)
+        goto start;
+
     sf_vec2 res = smc_platform_screensize(game->resolution, (float)game->scale);
     game->win = SDL_CreateWindow(
         game->title.c_str,
@@ -393,26 +467,32 @@ smc_game *smc_game_new(void) {
         (int)res.x, (int)res.y,
         SDL_WINDOW_SHOWN
     );
-    game->ren = SDL_CreateRenderer(
-        game->win, -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
-    );
-    if (!game->win || !game->ren) {
+    if (!game->win) {
         printf(TUI_ERR "Create Error: %s\n" TUI_CLEAR, SDL_GetError());
         smc_game_free(game);
         return NULL;
     }
-
-    game->open = true;
-    game->screen = SDL_CreateTexture(
-        game->ren,
-        SDL_PIXELFORMAT_RGBA8888,
-        SDL_TEXTUREACCESS_TARGET,
-        (int)game->resolution.x,
-        (int)game->resolution.y
-    );
-    SDL_SetTextureScaleMode(game->screen, SDL_ScaleModeNearest);
     SDL_SetWindowResizable(game->win, SDL_TRUE);
+
+#if defined(SMC_EXPERIMENTAL_RENDER_THREAD) && !defined(_WIN32) && !defined(__APPLE__) && !defined(__vita__)
+    // GL contexts on X11 can't follow the renderer to another thread
+    const char *driver = SDL_GetCurrentVideoDriver();
+    if (render_thread && (!driver || strcmp(driver, "x11") == 0)) {
+        smc_err("window.render_thread is not supported with the x11 video driver, rendering on the main thread", NULL);
+        render_thread = false;
+    }
+#endif
+
+    game->render.clear_color = game->clear_color;
+    if (!smc_render_init(
+        &game->render, game->win,
+        (int)game->resolution.x, (int)game->resolution.y,
+        game->pacing.vsync, render_thread
+    )) {
+        smc_game_free(game);
+        return NULL;
+    }
+start:
     smc_register(game);
 
     if (smc_changeroom(game, "start")) {
@@ -442,33 +522,38 @@ smc_game *smc_game_new(void) {
     return game;
 }
 
-typedef struct {
-    solu_f64 depth;
-    solu_val drawable;
-} smc_draw;
-
 static inline void smc_update_globals(smc_game *g) {
     solu_val mouse = solu_getg(g->s, "mouse");
     if (!solu_isdtype(mouse, SOLU_DOBJ)) {
         mouse = solu_dnew(g->s, SOLU_DOBJ);
         solu_setg(g->s, "mouse", mouse);
     }
-    int x, y, win_w, win_h;
-    SDL_GetMouseState(&x, &y);
-    SDL_GetWindowSize(g->win, &win_w, &win_h);
+    if (g->win) {
+        int x, y, win_w, win_h;
+        SDL_GetMouseState(&x, &y);
+        SDL_GetWindowSize(g->win, &win_w, &win_h);
 
-    float scaleX = (float)win_w / g->resolution.x;
-    float scaleY = (float)win_h / g->resolution.y;
-    float scale = scaleX < scaleY ? scaleX : scaleY;
+        float scaleX = (float)win_w / g->resolution.x;
+        float scaleY = (float)win_h / g->resolution.y;
+        float scale = scaleX < scaleY ? scaleX : scaleY;
 
-    float gx = ((float)x - (((float)win_w - g->resolution.x * scale) / 2)) / scale;
-    float gy = ((float)y - (((float)win_h - g->resolution.y * scale) / 2)) / scale;
-    solu_dobj_strset(mouse.dyn, "x", (solu_val){SOLU_TF64, .f64=gx});
-    solu_dobj_strset(mouse.dyn, "y", (solu_val){SOLU_TF64, .f64=gy});
+        float gx = ((float)x - (((float)win_w - g->resolution.x * scale) / 2)) / scale;
+        float gy = ((float)y - (((float)win_h - g->resolution.y * scale) / 2)) / scale;
+        solu_dobj_strset(mouse.dyn, "x", (solu_val){SOLU_TF64, .f64=gx});
+        solu_dobj_strset(mouse.dyn, "y", (solu_val){SOLU_TF64, .f64=gy});
+    }
 
     solu_f64 now = solu_timesec();
-    solu_dobj_strset(g->ginfo.dyn, "delta_time", (solu_val){SOLU_TF64, .f64 = now - g->last_time});
+    g->frame_time = now - g->last_time;
     g->last_time = now;
+    // Headless runs simulate time instead of measuring it, one step per frame
+    // however fast the loop spins, so runs are deterministic and --frames
+    // counts simulation steps
+    if (g->headless)
+        g->frame_time = g->timestep.fixed ? g->timestep.step : SMC_HEADLESS_STEP;
+    solu_dobj_strset(g->ginfo.dyn, "frame_time", (solu_val){SOLU_TF64, .f64 = g->frame_time});
+    if (!g->timestep.fixed)
+        solu_dobj_strset(g->ginfo.dyn, "delta_time", (solu_val){SOLU_TF64, .f64 = g->frame_time});
 }
 
 static inline void smc_update_camera(smc_game *g) {
@@ -491,7 +576,7 @@ static inline void smc_update_camera(smc_game *g) {
     }
 }
 
-static int smc_game_input(smc_game *g) {
+static inline void smc_clear_input(smc_game *g) {
     memset(g->keys_pressed, 0, sizeof(g->keys_pressed));
     memset(g->keys_released, 0, sizeof(g->keys_released));
     memset(g->mouse_pressed, 0, sizeof(g->mouse_pressed));
@@ -500,12 +585,25 @@ static int smc_game_input(smc_game *g) {
     g->mouse_wheel = 0;
     g->text_input_len = 0;
     g->text_input[0] = '\0';
+}
+
+static int smc_game_input(smc_game *g) {
+    // Edges are kept until an update has seen them, a frame may run zero fixed steps
+    if (g->input_consumed) {
+        smc_clear_input(g);
+        g->input_consumed = false;
+    }
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
         if (e.type == SDL_QUIT) {
             g->open = false;
             return -1;
         }
+        // D3D drops render target contents on resizes and fullscreen toggles
+        if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+            for (uint32_t i = 0; i < g->layer_c; ++i)
+                smc_layer_invalidate(g->layers + i);
+        }
         if (e.type == SDL_KEYDOWN && !e.key.repeat) {
             SDL_Scancode sc = e.key.keysym.scancode;
             g->keys_pressed[sc] = true;
@@ -535,13 +633,10 @@ static int smc_game_input(smc_game *g) {
     return 0;
 }
 
-static inline int check_room(smc_game *g, solu_val *snap, uint32_t count) {
+static inline int check_room(smc_game *g) {
     if (g->roomchange) {
         g->roomchange = false;
         g->camera = (sf_vec2){0, 0};
-        for (uint32_t i = 0; i < count; ++i)
-            solu_drelease(snap[i]);
-        free(snap);
 
         int i;
         if ((i = smc_changeroom(g, g->room.c_str))) {
@@ -553,151 +648,267 @@ static inline int check_room(smc_game *g, solu_val *snap, uint32_t count) {
     return 0;
 }
 
-static int smc_game_update(smc_game *g) {
-    solu_dobj *om = g->objects.dyn;
-    uint32_t count = om->array.count;
-    solu_val *snap = NULL;
-    int rc = 0;
+// Objects spawned during a phase join it next frame
+static int smc_game_phase(smc_game *g, smc_method m) {
+    smc_object_compact(g, m);
+    smc_registry *r = &g->phases[m];
+    uint32_t count = r->count;
     int ir = 0;
 
-    if (count) {
-        snap = malloc(sizeof(*snap) * count);
-        if (!snap) abort();
-
-        for (uint32_t i = 0; i < count; ++i) {
-            snap[i] = om->array.data[i];
-            solu_dhold(snap[i]);
-        }
-    } else {
-        smc_update_camera(g);
-        return 0;
-    };
-
+    smc_frect view = {g->camera.x, g->camera.y, g->resolution.x, g->resolution.y};
+    solu_f64 dt = g->timestep.fixed ? g->timestep.step : g->frame_time;
     for (uint32_t i = 0; i < count; ++i) {
-        solu_val obj = snap[i];
-        if (!solu_isdtype(obj, SOLU_DOBJ))
-            continue;
-
-        if (!g->paused && smc_callmethod(g, obj.dyn, "update")) {
-            if (!g->open) {
-                rc = -1;
-                break;
-            }
-            if ((ir = check_room(g, snap, count)))
-                return ir > 0 ? 0 : -1;
+        if (m == SMC_METHOD_UPDATE) {
+            if (!smc_object_active(g, r->ids[i], view))
+                continue;
+            smc_object_elapsed(g, r->ids[i], dt);
         }
-
-        if (smc_callmethod(g, obj.dyn, "tick")) {
-            if (!g->open) {
-                rc = -1;
-                break;
-            }
-            if ((ir = check_room(g, snap, count)))
-                return ir > 0 ? 0 : -1;
+        if (smc_callobject(g, r->ids[i], m)) {
+            if (!g->open)
+                return -1;
+            if ((ir = check_room(g)))
+                return ir;
         }
     }
+    return 0;
+}
 
-    for (uint32_t i = 0; i < count; ++i)
-        solu_drelease(snap[i]);
-    free(snap);
-
-    if (rc < 0)
+static int smc_game_update(smc_game *g) {
+    int ir = 0;
+    ++g->steps;
+    if (!g->paused) {
+        if ((ir = smc_game_phase(g, SMC_METHOD_UPDATE)))
+            return ir > 0 ? 0 : -1;
+
+        solu_f64 dt = g->timestep.fixed ? g->timestep.step : g->frame_time;
+        smc_object_integrate(g, dt);
+        smc_particles_step(&g->particles, (float)dt);
+        smc_animators_step(&g->animators, (float)dt);
+        g->clock += dt;
+        smc_wheel_advance(&g->timers, (uint64_t)(g->clock * 1000), smc_timer_fire, g);
+        smc_bus_flush(&g->events, smc_event_fire, g);
+        if (!g->open)
+            return -1;
+        if ((ir = check_room(g)))
+            return ir > 0 ? 0 : -1;
+    }
+    if ((ir = smc_game_phase(g, SMC_METHOD_TICK)))
+        return ir > 0 ? 0 : -1;
+    smc_bus_flush(&g->events, smc_event_fire, g);
+    if (!g->open)
         return -1;
+    if ((ir = check_room(g)))
+        return ir > 0 ? 0 : -1;
 
     smc_update_camera(g);
     return 0;
 }
 
+static inline void smc_game_layer(smc_game *g, smc_layer *l) {
+    if (!g->render.active) return;
+    smc_layer_draw(l, &g->render, (smc_frect){g->camera.x, g->camera.y, g->resolution.x, g->resolution.y});
+}
+
 static int smc_game_draw(smc_game *g) {
-    solu_dobj *om = g->objects.dyn;
-    smc_draw *sort = NULL;
-    uint32_t sort_c = om->array.count;
-    if (sort_c) {
-        sort = calloc(sort_c, sizeof(smc_draw));
-        if (!sort) return -1;
-    }
-
-    for (uint32_t i = 0; i < om->array.count; ++i) {
-        solu_val *obj = om->array.data + i;
-        if (!solu_isdtype(*obj, SOLU_DOBJ)) continue;
-        solu_val dv = solu_dobj_strget(obj->dyn, "depth");
-        solu_f64 depth = dv.tt == SOLU_TF64 ? dv.f64 : 0;
-        for (smc_draw *cc = sort; cc < sort + om->array.count; ++cc) {
-            if (cc->drawable.tt == SOLU_TNIL) {
-                *cc = (smc_draw){depth, *obj};
-                break;
-            }
-            if (cc->depth > depth) {
-                size_t tail = (size_t)((sort + sort_c) - (cc + 1));
-                memmove(cc + 1, cc, tail * sizeof(*cc));
-                *cc = (smc_draw){ depth, *obj };
-                break;
+    g->drawing = true;
+    for (int i = 0; i < 2; ++i) {
+        smc_method m = i ? SMC_METHOD_DRAW_GUI : SMC_METHOD_DRAW;
+        smc_object_compact(g, m);
+        smc_object_order(g, m);
+        smc_drawlist *d = &g->order[i];
+
+        // Tile layers interleave with the world pass, each goes before the
+        // first object deeper than it
+        g->gui = i;
+        uint32_t layer = i ? g->layer_c : 0;
+        // Spawns and depth changes made while drawing settle next frame. An
+        // entry whose slot lost its order bit was deleted mid-pass, possibly
+        // with a new object already spawned into the slot, and is skipped.
+        uint8_t bit = (uint8_t)(1u << i);
+        for (uint32_t k = 0; k < d->count; ++k) {
+            uint32_t id = d->ids[k];
+            if (!(g->records[id].ordered & bit))
+                continue;
+            for (; layer < g->layer_c && g->layers[layer].depth <= g->records[id].depth; ++layer)
+                smc_game_layer(g, g->layers + layer);
+            if (smc_callobject(g, id, m)) {
+                if (!g->open)
+                    return -1;
+                smc_update_camera(g);
             }
         }
+        for (; layer < g->layer_c; ++layer)
+            smc_game_layer(g, g->layers + layer);
     }
+    g->drawing = g->gui = false;
+    return 0;
+}
 
-    SDL_SetRenderTarget(g->ren, g->screen);
-        SDL_SetRenderDrawColor(
-            g->ren,
-            g->clear_color.r,
-            g->clear_color.g,
-            g->clear_color.b,
-            g->clear_color.a
-        );
-        SDL_RenderClear(g->ren);
-        g->drawing = true;
-        for (int i = 0; i < 2; ++i) {
-            g->gui = i;
-            for (smc_draw *draw = sort; draw < sort + sort_c; ++draw) {
-                if (!solu_isdtype(draw->drawable, SOLU_DOBJ)) continue;
-                if (smc_callmethod(g, draw->drawable.dyn, i ? "draw_gui" : "draw")) {
-                    if (!g->open) {
-                        free(sort);
-                        return -1;
-                    }
-                    smc_update_camera(g);
-                }
-            }
+static int smc_game_step(smc_game *g) {
+    smc_timestep *ts = &g->timestep;
+    if (!ts->fixed) {
+        g->input_consumed = true;
+        return smc_game_update(g);
+    }
+
+    ts->accum += g->frame_time;
+    uint32_t steps = 0;
+    while (ts->accum >= ts->step && steps < ts->max_steps) {
+        // Edge input only fires on the first step of a frame
+        if (steps++) smc_clear_input(g);
+        g->input_consumed = true;
+        ts->accum -= ts->step;
+        if (smc_game_update(g) < 0)
+            return -1;
+    }
+    // Drop whatever could not be caught up rather than spiraling
+    if (ts->accum >= ts->step)
+        ts->accum = fmod(ts->accum, ts->step);
+    solu_dobj_strset(g->ginfo.dyn, "alpha", (solu_val){SOLU_TF64, .f64 = ts->accum / ts->step});
+    return 0;
+}
+
+// Jobs requeued or deferred while draining wait for the next frame
+static int smc_game_jobs(smc_game *g) {
+    smc_jobq *q = &g->jobs;
+    uint32_t n = q->count;
+    if (!n) return 0;
+    uint64_t deadline = SDL_GetPerformanceCounter()
+        + (uint64_t)(q->budget * (solu_f64)SDL_GetPerformanceFrequency());
+
+    do {
+        smc_job job = smc_jobs_pop(q);
+
+        smc_object *o = job.owner ? smc_object_get(g, job.owner) : NULL;
+        if (job.owner && !o) {
+            solu_drelease(job.fn); // Its object is gone
+            continue;
+        }
+        // Like its timers, an object's jobs wait out a pause
+        if (o && g->paused) {
+            smc_jobs_push(q, job);
+            continue;
         }
-        g->drawing = g->gui = false;
-    SDL_SetRenderTarget(g->ren, NULL);
-    free(sort);
+        solu_val obj = o ? o->obj : SOLU_NIL;
+        solu_dhold(obj);
+        g->ocall = obj;
+        solu_call_ex call_ex = solu_call(g->s, job.fn.dyn, NULL, 0);
+        g->ocall = SOLU_NIL;
+        solu_drelease(obj);
+        if (!call_ex.is_ok) {
+            smc_err("Deferred job error: %s", call_ex.err.panic ? call_ex.err.panic : solu_err_string(call_ex.err.tt));
+            if (g->err_pause)
+                smc_pause(g, true);
+        }
+
+        if (call_ex.is_ok && call_ex.ok.tt == SOLU_TBOOL && call_ex.ok.boolean)
+            smc_jobs_push(q, job);
+        else solu_drelease(job.fn);
+
+        if (!g->open)
+            return -1;
+        int ir;
+        if ((ir = check_room(g)))
+            return ir > 0 ? 0 : -1;
+    } while (--n && SDL_GetPerformanceCounter() < deadline);
     return 0;
 }
 
-int smc_game_run(void) {
-    smc_game *g = smc_game_new();
+#define SMC_SPIN_MS 2
+
+static void smc_pace_frame(smc_game *g) {
+    smc_pacing *p = &g->pacing;
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    if (p->period) {
+        if (!p->deadline || now > p->deadline + p->period) {
+            // First frame or too far behind to catch up, start a fresh schedule
+            p->deadline = now;
+        } else {
+            // Sleep while comfortably early, then spin out the last stretch
+            while (now < p->deadline) {
+                uint64_t left_ms = (p->deadline - now) * 1000 / freq;
+                if (left_ms > SMC_SPIN_MS)
+                    SDL_Delay((uint32_t)(left_ms - SMC_SPIN_MS));
+                now = SDL_GetPerformanceCounter();
+            }
+        }
+        p->deadline += p->period;
+    }
+
+    if (p->last) {
+        solu_f64 interval = (solu_f64)(now - p->last) / (solu_f64)freq;
+        solu_f64 expect = p->period ? (solu_f64)p->period / (solu_f64)freq : p->interval;
+        p->interval = p->interval ? p->interval * 0.9 + interval * 0.1 : interval;
+        p->jitter = p->jitter * 0.9 + fabs(interval - expect) * 0.1;
+        solu_dobj_strset(g->ginfo.dyn, "fps", (solu_val){SOLU_TF64, .f64 = 1.0 / p->interval});
+        solu_dobj_strset(g->ginfo.dyn, "jitter", (solu_val){SOLU_TF64, .f64 = p->jitter});
+    }
+    p->last = now;
+}
+
+static void smc_game_stats(smc_game *g) {
+    const smc_render_stats *st = &g->render.shown;
+    solu_dobj *d = g->stats.dyn;
+    solu_dobj_strset(d, "draws", (solu_val){SOLU_TI64, .i64 = st->draws});
+    solu_dobj_strset(d, "flushes", (solu_val){SOLU_TI64, .i64 = st->flushes});
+    solu_dobj_strset(d, "quads", (solu_val){SOLU_TI64, .i64 = st->quads});
+    solu_dobj_strset(d, "state_changes", (solu_val){SOLU_TI64, .i64 = st->state_changes});
+    solu_dobj_strset(d, "state_skips", (solu_val){SOLU_TI64, .i64 = st->state_skips});
+    solu_dobj_strset(d, "culled", (solu_val){SOLU_TI64, .i64 = g->culled});
+    solu_dobj_strset(d, "body_writes", (solu_val){SOLU_TI64, .i64 = g->body_writes});
+    g->culled = g->body_writes = 0;
+}
+
+int smc_game_run(int argc, char **argv) {
+    smc_options opts = {0};
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0)
+            opts.headless = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            opts.frames = strtoull(argv[++i], NULL, 10);
+        else smc_err("Unknown argument '%s'", argv[i]);
+    }
+
+    smc_game *g = smc_game_new(opts);
     if (!g) return -1;
 
+    solu_f64 started = solu_timesec();
     while (g->open) { // SDL2 Loop
+        if (g->max_frames && g->frame >= g->max_frames)
+            break;
+        ++g->frame;
         if (smc_game_input(g) < 0)
             goto close;
         smc_update_globals(g);
-        if (smc_game_update(g) < 0)
+        if (smc_game_step(g) < 0)
+            goto close;
+        if (smc_game_jobs(g) < 0)
             goto close;
         if (smc_game_draw(g) < 0)
             goto close;
+        if (!g->headless) {
+            // Hands the recorded frame to the renderer, presenting the previous one when threaded
+            smc_render_submit(&g->render);
+            smc_pace_frame(g);
+            smc_game_stats(g);
+        }
 
-        // Draw screen to window
-        int winW, winH;
-        SDL_GetRendererOutputSize(g->ren, &winW, &winH);
-        float scaleX = (float)winW / g->resolution.x;
-        float scaleY = (float)winH / g->resolution.y;
-        float scale = scaleX < scaleY ? scaleX : scaleY;
-        int dw = (int)(g->resolution.x * scale);
-        int dh = (int)(g->resolution.y * scale);
-
-        SDL_SetRenderDrawColor(g->ren, 0, 0, 0, 255);
-        SDL_RenderClear(g->ren);
-        SDL_RenderCopy(g->ren, g->screen, NULL, &(SDL_Rect){
-            (winW - dw) / 2,
-            (winH - dh) / 2,
-            dw,
-            dh
-        });
-        SDL_RenderPresent(g->ren);
+        size_t peak = g->arena.peak;
+        smc_arena_reset(&g->arena);
+        if (g->arena.peak != peak)
+            solu_dobj_strset(g->ginfo.dyn, "arena_peak", (solu_val){SOLU_TI64, .i64 = (solu_i64)g->arena.peak});
     }
 close:
+    if (g->headless) {
+        solu_f64 elapsed = solu_timesec() - started;
+        smc_info(
+            "Ran %" PRIu64 " steps (%.3fs simulated) in %.3fs (%.1f steps/s)",
+            g->steps, g->clock, elapsed, elapsed > 0 ? (double)g->steps / elapsed : 0.0
+        );
+    }
+    smc_info("Frame arena peak: %zu bytes", g->arena.peak);
     smc_info("Bye bye!", NULL);
     smc_game_free(g);
     return 0;
@@ -705,6 +916,15 @@ close:
 
 void smc_game_free(smc_game *game) {
     if (!game) return;
+    smc_object_clear(game);
+    smc_prototypes_free(&game->prototypes);
+    smc_wheel_free(&game->timers);
+    smc_bus_free(&game->events);
+    smc_bodies_free(&game->bodies);
+    smc_particles_free(&game->particles);
+    smc_animators_free(&game->animators);
+    smc_tilemap_clear(game);
+    smc_jobs_free(&game->jobs);
     solu_state_free(game->s);
     sf_str_free(game->title);
     sf_str_free(game->room);
@@ -712,14 +932,14 @@ void smc_game_free(smc_game *game) {
     sf_str_free(game->obj_dir);
     sf_str_free(game->spr_dir);
     sf_str_free(game->snd_dir);
+    sf_str_free(game->cache_dir);
     solu_valmap_free(&game->spr_cache);
     solu_valmap_free(&game->mus_cache);
-    if (game->screen)
-        SDL_DestroyTexture(game->screen);
-    if (game->ren)
-        SDL_DestroyRenderer(game->ren);
-    if (game->win) {
+    smc_atlas_free(&game->atlas, &game->render);
+    smc_render_free(&game->render);
+    if (game->win)
         SDL_DestroyWindow(game->win);
+    if (game->win || game->headless) {
         Mix_Quit();
         IMG_Quit();
         SDL_Quit();
@@ -729,6 +949,13 @@ void smc_game_free(smc_game *game) {
             smc_partition_free(&game->collision_data.partitions[i]);
         free(game->collision_data.partitions);
     }
+    smc_arena_free(&game->arena);
+    free(game->records);
+    free(game->live);
+    for (int m = 0; m < SMC_METHOD_COUNT; ++m)
+        free(game->phases[m].ids);
+    for (int i = 0; i < SMC_DRAW_PHASES; ++i)
+        free(game->order[i].ids);
     free(game);
 }
 
@@ -737,7 +964,6 @@ void smc_game_free(smc_game *game) {
 #endif
 
 int main(int argc, char **argv) {
-    (void)argc; (void)argv;
     #if !defined(_WIN32) && !defined(__vita__)
     char *cwd, *f = solu_realpath(argv[0]);
     if (!f || !(cwd = solu_realdir(f)) || chdir(cwd) != 0) {
@@ -746,7 +972,7 @@ int main(int argc, char **argv) {
     }
     free(f); free(cwd);
     #endif
-    return smc_game_run();
+    return smc_game_run(argc, argv);
 }
 
 
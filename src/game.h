@@ -1,7 +1,16 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "anim.h"
+#include "arena.h"
 #include "asset.h"
+#include "body.h"
+#include "event.h"
+#include "job.h"
+#include "particle.h"
+#include "render.h"
+#include "tilemap.h"
+#include "timer.h"
 #include "platforms/platforms.h"
 #include "solus/val.h"
 #include <solus/api.h>
@@ -20,36 +29,161 @@ typedef struct {
 } smc_collision;
 void smc_update_world(smc_collision *c, smc_irect world, uint32_t grid);
 
+// Compiled object script by type, kept until load.invalidate(). Deleted
+// load.pooled() instances wait in 'pool' to be reset and reused, up to
+// SMC_POOL_MAX per type.
+#define SMC_POOL_MAX 256
+typedef struct {
+    char *path;
+    solu_fproto fp;
+    solu_val *pool;
+    uint32_t pool_c, pool_cap;
+    int8_t resettable; // 0 unchecked, 1 has reset(), -1 can't be pooled
+} smc_prototype;
+static inline void smc_prototype_free(smc_prototype *proto) {
+    for (uint32_t i = 0; i < proto->pool_c; ++i)
+        solu_drelease(proto->pool[i]);
+    free(proto->pool);
+    free(proto->path);
+    solu_fproto_free(&proto->fp);
+    free(proto);
+}
+#define MAP_NAME smc_prototypes
+#define MAP_K sf_str
+#define MAP_V smc_prototype *
+#define EQUAL_FN(s1, s2) (sf_str_eq(s1, s2))
+#define HASH_FN(s) (sf_str_hash(s))
+#define KCLEANUP sf_str_free
+#define VCLEANUP smc_prototype_free
+#include <sf/containers/map.h>
+
+typedef enum {
+    SMC_METHOD_UPDATE,
+    SMC_METHOD_TICK,
+    SMC_METHOD_DRAW,
+    SMC_METHOD_DRAW_GUI,
+    SMC_METHOD_COUNT,
+} smc_method;
+
+// Parsed from an object's 'activity' field, decides whether update() runs:
+// 'onscreen' and 'near' test its x/y against the view, an integer N runs it
+// every Nth step with self.delta_time set to the time since its last update
+typedef enum {
+    SMC_ACTIVE_ALWAYS,
+    SMC_ACTIVE_ONSCREEN,
+    SMC_ACTIVE_NEAR,
+    SMC_ACTIVE_EVERY,
+} smc_activity_type;
+#define SMC_ACTIVITY_RANGE 128 // Default 'activity_range' margin for 'near'
+typedef struct {
+    smc_activity_type tt;
+    uint32_t every;
+    solu_f64 range;
+} smc_activity;
+
+// Native record of a live object, lifecycle methods are resolved once when it
+// spawns and refreshed by the object's setter if a script reassigns one
+typedef struct {
+    solu_val obj;
+    solu_val methods[SMC_METHOD_COUNT];
+    uint32_t slots[SMC_METHOD_COUNT]; // Index + 1 into the phase registry
+    uint32_t gen, next, dense;
+    uint32_t subs; // Chain of event subscriptions it owns
+    uint32_t body; // Index + 1 into the game's bodies
+    solu_f64 depth; // Mirrors the 'depth' field through the setter
+    uint8_t ordered; // Bit per draw phase whose order lists it
+    smc_activity activity;
+    solu_f64 updated; // Clock at the end of its last every-Nth update
+    bool pooled;
+} smc_object;
+
+// Slots of objects subscribed to one lifecycle method in spawn order, removals leave a
+// tombstone that is swept out before the phase next runs
+#define SMC_REGISTRY_DEAD UINT32_MAX
+typedef struct {
+    uint32_t *ids;
+    uint32_t count, cap, dead;
+} smc_registry;
+
+// Draw phase slots by depth, ties in registry order. Kept across frames and
+// only re-sorted once subscriptions or depths have changed, a few changes are
+// repaired in place and more trigger a full radix sort.
+#define SMC_DRAW_PHASES 2
+typedef struct {
+    uint32_t *ids;
+    uint32_t count, cap;
+    uint32_t changed;
+} smc_drawlist;
+
+// Fixed timestep, configured by manifest.solu 'timestep'. Headless runs
+// without one still step by SMC_HEADLESS_STEP.
+#define SMC_HEADLESS_STEP (1.0 / 60.0)
+typedef struct {
+    bool fixed;
+    solu_f64 step, accum;
+    uint32_t max_steps;
+} smc_timestep;
+
+// Frame limiter, configured by manifest.solu 'window.fps' and 'window.vsync'
+typedef struct {
+    bool vsync;
+    uint64_t period, deadline, last; // Performance counter ticks
+    solu_f64 interval, jitter;       // Running averages in seconds
+} smc_pacing;
+
 typedef struct {
     solu_state *s;
     solu_val manifest;
     sf_vec2 resolution, camera;
     solu_i64 scale;
     sf_str title;
-    uint32_t id_c;
+    uint32_t collider_c;
 
     sf_str room;
     smc_point room_size;
     solu_i64 grid;
 
     bool paused, drawing, gui;
-    bool roomchange, open;
+    bool roomchange, open, headless;
     SDL_Window *win;
-    SDL_Renderer *ren;
-    SDL_Texture *screen;
+    smc_renderer render;
     SDL_Color clear_color;
 
     solu_val ginfo, gptr;
+    solu_val stats; // game.stats, the renderer's counters for the last presented frame
+    uint32_t culled; // Script draws rejected off-screen since the last submit
+    uint32_t body_writes; // Body fields written back to scripts since then
     solu_val objects, rooms;
+    smc_object *records; // By slot, freed slots are chained through 'next'
+    uint32_t record_c, record_cap, free_head;
+    uint32_t *live; // Dense slots of live objects
+    uint32_t live_c, live_cap;
+    smc_registry phases[SMC_METHOD_COUNT];
+    smc_drawlist order[SMC_DRAW_PHASES]; // draw then draw_gui
+    smc_layer *layers; // Current room's tile layers by depth
+    uint32_t layer_c;
     solu_val load_cache;
-    sf_str room_dir, obj_dir, spr_dir, snd_dir;
+    sf_str room_dir, obj_dir, spr_dir, snd_dir, cache_dir;
     bool err_pause;
 
     solu_valmap spr_cache, mus_cache;
-    solu_val sprite, snd, music, obj;
-    solu_f64 last_time;
+    smc_atlas atlas; // Pages sprites are packed into when they fit
+    smc_prototypes prototypes;
+    solu_val sprite, snd, music, obj, oset, timer, emitter, animator;
+    solu_f64 last_time, frame_time;
+    uint64_t frame, max_frames, steps;
+    smc_timestep timestep;
+    smc_pacing pacing;
 
     smc_collision collision_data;
+    smc_arena arena; // Reset every frame
+    smc_wheel timers; // Runs on game time, stops while paused
+    smc_bus events;
+    smc_jobq jobs;
+    smc_bodies bodies; // Integrated after update, while unpaused
+    smc_particles particles; // Live emitters, stepped alongside bodies
+    smc_animators animators;
+    solu_f64 clock;
     solu_val ocall;
 
     bool keys_pressed[SDL_NUM_SCANCODES];
@@ -57,6 +191,7 @@ typedef struct {
     bool mouse_pressed[8];
     bool mouse_released[8];
     double mouse_wheel;
+    bool input_consumed;
 
     char text_input[256];
     size_t text_input_len;
@@ -72,12 +207,23 @@ typedef struct smc_collider {
     bool seen, enabled;
 } smc_collider;
 
-smc_game *smc_game_new(void);
-int smc_game_run(void);
+typedef struct {
+    bool headless;
+    uint64_t frames; // Exit after this many frames, 0 runs until quit
+} smc_options;
+
+smc_game *smc_game_new(smc_options opts);
+int smc_game_run(int argc, char **argv);
 void smc_game_free(smc_game *game);
 
 int smc_changeroom(smc_game *g, char *name);
 
+static inline void smc_pause(smc_game *g, bool toggle) {
+    g->paused = toggle;
+    solu_dobj_strset(g->ginfo.dyn, "paused", (solu_val){SOLU_TBOOL, .boolean=toggle});
+}
+
+bool smc_callfun(smc_game *g, solu_dobj *obj, solu_val fn, const char *name, solu_val *args, uint32_t argc);
 bool smc_callmethod(smc_game *g, solu_dobj *om, char *name);
 static inline void smc_callmethods(smc_game *g, solu_dobj *om, char *name) {
     for (solu_val *obj = om->array.data; obj < om->array.data + om->array.count; ++obj) {
@@ -0,0 +1,33 @@
+#include "job.h"
+#include <stdlib.h>
+
+void smc_jobs_push(smc_jobq *q, smc_job job) {
+    if (q->count == q->cap) {
+        uint32_t cap = q->cap ? q->cap * 2 : 64;
+        smc_job *data = malloc(cap * sizeof(smc_job));
+        if (!data) abort();
+        // Unwrap the ring so it starts at zero again
+        for (uint32_t i = 0; i < q->count; ++i)
+            data[i] = q->data[(q->head + i) % q->cap];
+        free(q->data);
+        q->data = data;
+        q->head = 0;
+        q->cap = cap;
+    }
+    q->data[(q->head + q->count++) % q->cap] = job;
+}
+
+// Only valid while count is nonzero
+smc_job smc_jobs_pop(smc_jobq *q) {
+    smc_job job = q->data[q->head];
+    q->head = (q->head + 1) % q->cap;
+    --q->count;
+    return job;
+}
+
+void smc_jobs_free(smc_jobq *q) {
+    for (uint32_t i = 0; i < q->count; ++i)
+        solu_drelease(q->data[(q->head + i) % q->cap].fn);
+    free(q->data);
+    *q = (smc_jobq){0};
+}
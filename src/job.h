@@ -0,0 +1,25 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include <solus/api.h>
+#include <stdint.h>
+
+// Deferred script work, drained between update and draw within a time budget.
+// Jobs owned by an object are dropped once it is gone.
+typedef struct {
+    solu_val fn;
+    solu_i64 owner;
+} smc_job;
+
+// Ring buffer in submission order
+typedef struct {
+    smc_job *data;
+    uint32_t head, count, cap;
+    solu_f64 budget; // Seconds per frame, at least one job always runs
+} smc_jobq;
+
+void smc_jobs_push(smc_jobq *q, smc_job job);
+smc_job smc_jobs_pop(smc_jobq *q);
+void smc_jobs_free(smc_jobq *q);
+
+#endif // JOB_H
@@ -0,0 +1,538 @@
+#include "object.h"
+#include <stdlib.h>
+#include <string.h>
+
+const char *const SMC_METHODS[SMC_METHOD_COUNT] = {
+    [SMC_METHOD_UPDATE] = "update",
+    [SMC_METHOD_TICK] = "tick",
+    [SMC_METHOD_DRAW] = "draw",
+    [SMC_METHOD_DRAW_GUI] = "draw_gui",
+};
+
+// Fields the object setter reacts to, everything else is stored and left be
+typedef enum {
+    SMC_KEY_PLAIN,
+    SMC_KEY_METHOD,
+    SMC_KEY_ACTIVITY,
+    SMC_KEY_DEPTH,
+    SMC_KEY_BODY,
+    SMC_KEY_BODY_FIELD,
+} smc_key;
+
+// Every script field write lands here, so a single switch on the first
+// character settles most keys and only the few sharing one with an engine
+// field go on to a full compare. 'index' gets the method or body field.
+static smc_key smc_object_key(const char *key, int *index) {
+    switch (key[0]) {
+        case 'x': case 'y':
+            if (key[1]) return SMC_KEY_PLAIN;
+            *index = key[0] == 'x' ? SMC_BODY_X : SMC_BODY_Y;
+            return SMC_KEY_BODY_FIELD;
+        case 'v':
+            if ((key[1] != 'x' && key[1] != 'y') || key[2]) return SMC_KEY_PLAIN;
+            *index = key[1] == 'x' ? SMC_BODY_VX : SMC_BODY_VY;
+            return SMC_KEY_BODY_FIELD;
+        case 'a':
+            if ((key[1] == 'x' || key[1] == 'y') && !key[2]) {
+                *index = key[1] == 'x' ? SMC_BODY_AX : SMC_BODY_AY;
+                return SMC_KEY_BODY_FIELD;
+            }
+            if (strncmp(key, "activity", 8) == 0 && (!key[8] || strcmp(key + 8, "_range") == 0))
+                return SMC_KEY_ACTIVITY;
+            return SMC_KEY_PLAIN;
+        case 'b':
+            return strcmp(key, "body") == 0 ? SMC_KEY_BODY : SMC_KEY_PLAIN;
+        case 'm':
+            if (strcmp(key, "max_speed") != 0) return SMC_KEY_PLAIN;
+            *index = SMC_BODY_MAX_SPEED;
+            return SMC_KEY_BODY_FIELD;
+        case 'u':
+            if (strcmp(key, "update") != 0) return SMC_KEY_PLAIN;
+            *index = SMC_METHOD_UPDATE;
+            return SMC_KEY_METHOD;
+        case 't':
+            if (strcmp(key, "tick") != 0) return SMC_KEY_PLAIN;
+            *index = SMC_METHOD_TICK;
+            return SMC_KEY_METHOD;
+        case 'd':
+            if (strncmp(key, "draw", 4) == 0 && (!key[4] || strcmp(key + 4, "_gui") == 0)) {
+                *index = key[4] ? SMC_METHOD_DRAW_GUI : SMC_METHOD_DRAW;
+                return SMC_KEY_METHOD;
+            }
+            if (strcmp(key, "depth") == 0) return SMC_KEY_DEPTH;
+            if (strcmp(key, "drag") != 0) return SMC_KEY_PLAIN;
+            *index = SMC_BODY_DRAG;
+            return SMC_KEY_BODY_FIELD;
+        default:
+            return SMC_KEY_PLAIN;
+    }
+}
+
+_Static_assert(SMC_METHOD_COUNT - SMC_METHOD_DRAW == SMC_DRAW_PHASES, "draw phases come last");
+
+// Draw phases keep an order list, the others run in registry order
+static inline smc_drawlist *smc_object_drawlist(smc_game *g, smc_method m) {
+    return m >= SMC_METHOD_DRAW ? g->order + (m - SMC_METHOD_DRAW) : NULL;
+}
+
+static void smc_object_subscribe(smc_game *g, uint32_t slot, smc_method m) {
+    smc_object *o = g->records + slot;
+    smc_registry *r = &g->phases[m];
+    if (o->slots[m]) return;
+    if (r->count == r->cap) {
+        uint32_t cap = r->cap ? r->cap * 2 : 64;
+        uint32_t *ids = realloc(r->ids, cap * sizeof(uint32_t));
+        if (!ids) abort();
+        r->ids = ids;
+        r->cap = cap;
+    }
+    r->ids[r->count++] = slot;
+    o->slots[m] = r->count;
+    smc_drawlist *d = smc_object_drawlist(g, m);
+    if (d) ++d->changed;
+}
+
+static void smc_object_unsubscribe(smc_game *g, uint32_t slot, smc_method m) {
+    smc_object *o = g->records + slot;
+    smc_registry *r = &g->phases[m];
+    if (!o->slots[m]) return;
+    r->ids[o->slots[m] - 1] = SMC_REGISTRY_DEAD;
+    ++r->dead;
+    o->slots[m] = 0;
+    smc_drawlist *d = smc_object_drawlist(g, m);
+    if (d) {
+        o->ordered &= (uint8_t)~(1u << (m - SMC_METHOD_DRAW));
+        ++d->changed;
+    }
+}
+
+static inline void smc_object_refresh(smc_game *g, uint32_t slot, smc_method m) {
+    if (solu_isdtype(g->records[slot].methods[m], SOLU_DFUN))
+        smc_object_subscribe(g, slot, m);
+    else smc_object_unsubscribe(g, slot, m);
+}
+
+static uint32_t smc_object_slot(smc_game *g) {
+    if (g->free_head) {
+        uint32_t slot = g->free_head - 1;
+        g->free_head = g->records[slot].next;
+        return slot;
+    }
+    if (g->record_c == g->record_cap) {
+        uint32_t cap = g->record_cap ? g->record_cap * 2 : 64;
+        smc_object *records = realloc(g->records, cap * sizeof(smc_object));
+        if (!records) abort();
+        g->records = records;
+        g->record_cap = cap;
+    }
+    // Generation 0 is never handed out so a zeroed id can't resolve
+    g->records[g->record_c] = (smc_object){.gen = 1};
+    return g->record_c++;
+}
+
+static void smc_object_activity(smc_game *g, smc_object *o) {
+    smc_activity a = {SMC_ACTIVE_ALWAYS, 1, SMC_ACTIVITY_RANGE};
+    solu_val v = solu_dobj_strget(o->obj.dyn, "activity");
+    if (v.tt == SOLU_TI64 && v.i64 > 1) {
+        a.tt = SMC_ACTIVE_EVERY;
+        a.every = v.i64 > UINT32_MAX ? UINT32_MAX : (uint32_t)v.i64;
+    } else if (solu_isdtype(v, SOLU_DSTR)) {
+        if (strcmp(v.dyn, "onscreen") == 0) a.tt = SMC_ACTIVE_ONSCREEN;
+        else if (strcmp(v.dyn, "near") == 0) a.tt = SMC_ACTIVE_NEAR;
+        else if (strcmp(v.dyn, "always") != 0)
+            smc_err("Unknown activity '%s', expected always|onscreen|near|i64", (char *)v.dyn);
+    }
+    solu_val r = solu_dobj_strget(o->obj.dyn, "activity_range");
+    if (r.tt == SOLU_TF64) a.range = r.f64;
+    else if (r.tt == SOLU_TI64) a.range = (solu_f64)r.i64;
+    // Throttled objects count their elapsed time from when they became so
+    if (a.tt == SMC_ACTIVE_EVERY && o->activity.tt != SMC_ACTIVE_EVERY)
+        o->updated = g->clock;
+    o->activity = a;
+}
+
+static inline bool smc_number(solu_val v, solu_f64 *out) {
+    if (v.tt == SOLU_TF64) *out = v.f64;
+    else if (v.tt == SOLU_TI64) *out = (solu_f64)v.i64;
+    else return false;
+    return true;
+}
+
+static void smc_object_depth(smc_game *g, smc_object *o) {
+    solu_f64 depth = 0;
+    smc_number(solu_dobj_strget(o->obj.dyn, "depth"), &depth);
+    if (depth == o->depth) return;
+    o->depth = depth;
+    for (int i = 0; i < SMC_DRAW_PHASES; ++i)
+        if (o->ordered & (1u << i)) ++g->order[i].changed;
+}
+
+// 'body' set to true or an obj moves the object natively from its x/y,
+// vx/vy, ax/ay, drag and max_speed fields
+static void smc_object_body(smc_game *g, uint32_t slot) {
+    smc_object *o = g->records + slot;
+    solu_val v = solu_dobj_strget(o->obj.dyn, "body");
+    bool want = (v.tt == SOLU_TBOOL && v.boolean) || solu_isdtype(v, SOLU_DOBJ);
+    if (!want) {
+        if (!o->body) return;
+        uint32_t moved = smc_bodies_remove(&g->bodies, o->body - 1);
+        if (moved != UINT32_MAX) g->records[moved].body = o->body;
+        o->body = 0;
+        return;
+    }
+    if (!o->body)
+        o->body = smc_bodies_add(&g->bodies, slot) + 1;
+    uint32_t i = o->body - 1;
+    for (int f = 0; f < SMC_BODY_FIELD_COUNT; ++f) {
+        solu_f64 n = 0;
+        smc_number(solu_dobj_strget(o->obj.dyn, SMC_BODY_FIELDS[f]), &n);
+        g->bodies.fields[f][i] = n;
+    }
+    g->bodies.moved[i] = false;
+}
+
+smc_object *smc_object_at(smc_game *g, uint32_t slot) {
+    if (slot >= g->record_c) return NULL;
+    smc_object *o = g->records + slot;
+    return o->obj.tt == SOLU_TNIL ? NULL : o;
+}
+
+smc_object *smc_object_get(smc_game *g, solu_i64 id) {
+    smc_object *o = smc_object_at(g, smc_handle_slot(id));
+    return o && o->gen == smc_handle_gen(id) ? o : NULL;
+}
+
+// Grows storage once ahead of a batch spawn
+void smc_object_reserve(smc_game *g, uint32_t count) {
+    if (g->record_c + count > g->record_cap) {
+        uint32_t cap = g->record_cap ? g->record_cap : 64;
+        while (cap < g->record_c + count) cap *= 2;
+        smc_object *records = realloc(g->records, cap * sizeof(smc_object));
+        if (!records) abort();
+        g->records = records;
+        g->record_cap = cap;
+    }
+    if (g->live_c + count > g->live_cap) {
+        uint32_t cap = g->live_cap ? g->live_cap : 64;
+        while (cap < g->live_c + count) cap *= 2;
+        uint32_t *live = realloc(g->live, cap * sizeof(uint32_t));
+        if (!live) abort();
+        g->live = live;
+        g->live_cap = cap;
+    }
+}
+
+solu_i64 smc_object_alloc(smc_game *g, solu_val obj) {
+    uint32_t slot = smc_object_slot(g);
+    if (g->live_c == g->live_cap) {
+        uint32_t cap = g->live_cap ? g->live_cap * 2 : 64;
+        uint32_t *live = realloc(g->live, cap * sizeof(uint32_t));
+        if (!live) abort();
+        g->live = live;
+        g->live_cap = cap;
+    }
+    smc_object *o = g->records + slot;
+    o->obj = obj;
+    o->dense = g->live_c;
+    g->live[g->live_c++] = slot;
+    solu_dhold(obj);
+
+    solu_i64 id = smc_handle(slot, o->gen);
+    solu_dobj_strset(obj.dyn, "id", (solu_val){SOLU_TI64, .i64=id});
+
+    // The script table mirrors slots, pad it so reused slots index directly
+    solu_dobj *om = g->objects.dyn;
+    while (om->array.count <= slot)
+        solu_valvec_push(&om->array, SOLU_NIL);
+    solu_dobj_set(g->s, om, (solu_val){SOLU_TI64, .i64=slot}, obj);
+    return id;
+}
+
+void smc_object_bind(smc_game *g, solu_val obj) {
+    smc_object *o = smc_object_get(g, solu_dobj_strget(obj.dyn, "id").i64);
+    if (!o || o->obj.dyn != obj.dyn) return;
+
+    uint32_t slot = (uint32_t)(o - g->records);
+    for (int m = 0; m < SMC_METHOD_COUNT; ++m) {
+        solu_drelease(o->methods[m]);
+        o->methods[m] = solu_dobj_strget(obj.dyn, SMC_METHODS[m]);
+        solu_dhold(o->methods[m]);
+        smc_object_refresh(g, slot, (smc_method)m);
+    }
+    smc_object_activity(g, o);
+    smc_object_depth(g, o);
+    smc_object_body(g, slot);
+}
+
+void smc_object_release(smc_game *g, solu_i64 id) {
+    smc_object *o = smc_object_get(g, id);
+    if (!o) return;
+    uint32_t slot = (uint32_t)(o - g->records);
+    smc_bus_drop(&g->events, &o->subs);
+    if (o->body) {
+        uint32_t moved = smc_bodies_remove(&g->bodies, o->body - 1);
+        if (moved != UINT32_MAX) g->records[moved].body = o->body;
+        o->body = 0;
+    }
+    for (int m = 0; m < SMC_METHOD_COUNT; ++m) {
+        smc_object_unsubscribe(g, slot, (smc_method)m);
+        solu_drelease(o->methods[m]);
+        o->methods[m] = SOLU_NIL;
+    }
+
+    solu_dobj *om = g->objects.dyn;
+    if (slot < om->array.count)
+        solu_valvec_set(&om->array, slot, SOLU_NIL);
+
+    uint32_t last = g->live[--g->live_c];
+    g->live[o->dense] = last;
+    g->records[last].dense = o->dense;
+
+    solu_val obj = o->obj;
+    o->obj = SOLU_NIL;
+    o->activity = (smc_activity){0};
+    o->pooled = false;
+    ++o->gen;
+    o->next = g->free_head;
+    g->free_head = slot + 1;
+    solu_drelease(obj);
+}
+
+// Slots and generations survive, handles from the old room stay stale
+void smc_object_clear(smc_game *g) {
+    while (g->live_c) {
+        smc_object *o = g->records + g->live[g->live_c - 1];
+        smc_object_release(g, smc_handle((uint32_t)(o - g->records), o->gen));
+    }
+    for (int m = 0; m < SMC_METHOD_COUNT; ++m)
+        g->phases[m].count = g->phases[m].dead = 0;
+    for (int i = 0; i < SMC_DRAW_PHASES; ++i)
+        g->order[i].count = g->order[i].changed = 0;
+}
+
+// Never called while the phase is being walked, slots shift down
+void smc_object_compact(smc_game *g, smc_method m) {
+    smc_registry *r = &g->phases[m];
+    if (!r->dead) return;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < r->count; ++i) {
+        uint32_t slot = r->ids[i];
+        if (slot == SMC_REGISTRY_DEAD) continue;
+        r->ids[n++] = slot;
+        g->records[slot].slots[m] = n;
+    }
+    r->count = n;
+    r->dead = 0;
+}
+
+#define SMC_ORDER_REPAIR 8 // Changes fixed up by insertion before a full sort
+
+static inline bool smc_order_before(smc_game *g, smc_method m, uint32_t a, uint32_t b) {
+    smc_object *oa = g->records + a, *ob = g->records + b;
+    return oa->depth < ob->depth || (oa->depth == ob->depth && oa->slots[m] < ob->slots[m]);
+}
+
+// Maps a depth to an unsigned key with the same order
+static inline uint64_t smc_depth_key(solu_f64 depth) {
+    uint64_t bits;
+    depth += 0.0; // -0 sorts with 0
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits & (1ull << 63) ? ~bits : bits | (1ull << 63);
+}
+
+// Stable LSD radix sort by depth, scratch comes from the frame arena
+static void smc_order_radix(smc_game *g, uint32_t *ids, uint32_t n) {
+    if (n < 2) return;
+    uint64_t *keys = smc_arena_alloc(&g->arena, n * sizeof(uint64_t) * 2);
+    uint32_t *spare = smc_arena_alloc(&g->arena, n * sizeof(uint32_t));
+    uint64_t *ks = keys, *kt = keys + n;
+    uint32_t *is = ids, *it = spare;
+    for (uint32_t i = 0; i < n; ++i)
+        ks[i] = smc_depth_key(g->records[ids[i]].depth);
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        uint32_t count[256] = {0};
+        for (uint32_t i = 0; i < n; ++i)
+            ++count[(ks[i] >> shift) & 0xff];
+        // Rooms use a handful of depths, most bytes are shared by every key
+        if (count[(ks[0] >> shift) & 0xff] == n)
+            continue;
+        uint32_t sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            uint32_t c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t at = count[(ks[i] >> shift) & 0xff]++;
+            kt[at] = ks[i];
+            it[at] = is[i];
+        }
+        uint64_t *k = ks; ks = kt; kt = k;
+        uint32_t *t = is; is = it; it = t;
+    }
+    if (is != ids)
+        memcpy(ids, is, n * sizeof(uint32_t));
+}
+
+// Brings a draw phase's order up to date, run after it has been compacted
+void smc_object_order(smc_game *g, smc_method m) {
+    smc_drawlist *d = smc_object_drawlist(g, m);
+    if (!d || !d->changed) return;
+    smc_registry *r = &g->phases[m];
+    uint8_t bit = (uint8_t)(1u << (m - SMC_METHOD_DRAW));
+    if (d->cap < r->count) {
+        uint32_t cap = d->cap ? d->cap : 64;
+        while (cap < r->count) cap *= 2;
+        uint32_t *ids = realloc(d->ids, cap * sizeof(uint32_t));
+        if (!ids) abort();
+        d->ids = ids;
+        d->cap = cap;
+    }
+
+    if (d->changed > SMC_ORDER_REPAIR) {
+        for (uint32_t i = 0; i < r->count; ++i) {
+            d->ids[i] = r->ids[i];
+            g->records[r->ids[i]].ordered |= bit;
+        }
+        d->count = r->count;
+        smc_order_radix(g, d->ids, d->count);
+    } else {
+        // Unsubscribed entries drop out and new subscribers join at the end,
+        // then the few out of place are inserted back where they belong
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < d->count; ++i)
+            if (g->records[d->ids[i]].ordered & bit)
+                d->ids[n++] = d->ids[i];
+        for (uint32_t i = 0; i < r->count; ++i) {
+            smc_object *o = g->records + r->ids[i];
+            if (o->ordered & bit) continue;
+            o->ordered |= bit;
+            d->ids[n++] = r->ids[i];
+        }
+        d->count = n;
+        for (uint32_t i = 1; i < n; ++i) {
+            uint32_t id = d->ids[i], j = i;
+            for (; j > 0 && smc_order_before(g, m, id, d->ids[j - 1]); --j)
+                d->ids[j] = d->ids[j - 1];
+            d->ids[j] = id;
+        }
+    }
+    d->changed = 0;
+}
+
+void smc_object_start(smc_game *g, solu_val obj, solu_val fields) {
+    if (solu_isdtype(fields, SOLU_DOBJ))
+        solu_dappend(obj, fields);
+    smc_object_bind(g, obj);
+    smc_callmethod(g, obj.dyn, "start");
+}
+
+// Positions go back to script fields only for bodies that moved, velocities
+// only for bodies whose acceleration, drag or speed cap could change them.
+// Each field written is counted in game.stats.body_writes.
+void smc_object_integrate(smc_game *g, solu_f64 dt) {
+    smc_bodies *b = &g->bodies;
+    smc_bodies_step(b, dt);
+    for (uint32_t i = 0; i < b->count; ++i) {
+        if (!b->moved[i]) continue;
+        b->moved[i] = false;
+        solu_dobj *obj = g->records[b->owners[i]].obj.dyn;
+        solu_dobj_strset(obj, "x", (solu_val){SOLU_TF64, .f64=b->fields[SMC_BODY_X][i]});
+        solu_dobj_strset(obj, "y", (solu_val){SOLU_TF64, .f64=b->fields[SMC_BODY_Y][i]});
+        g->body_writes += 2;
+        if (!b->fields[SMC_BODY_AX][i] && !b->fields[SMC_BODY_AY][i]
+            && !b->fields[SMC_BODY_DRAG][i] && !b->fields[SMC_BODY_MAX_SPEED][i])
+            continue;
+        solu_dobj_strset(obj, "vx", (solu_val){SOLU_TF64, .f64=b->fields[SMC_BODY_VX][i]});
+        solu_dobj_strset(obj, "vy", (solu_val){SOLU_TF64, .f64=b->fields[SMC_BODY_VY][i]});
+        g->body_writes += 2;
+    }
+}
+
+bool smc_callobject(smc_game *g, uint32_t slot, smc_method method) {
+    smc_object *o = smc_object_at(g, slot);
+    if (!o || !solu_isdtype(o->methods[method], SOLU_DFUN))
+        return false;
+    // The record may be rebound or moved while the method runs
+    solu_val obj = o->obj, fn = o->methods[method];
+    solu_dhold(obj);
+    bool called = smc_callfun(g, obj.dyn, fn, SMC_METHODS[method], NULL, 0);
+    solu_drelease(obj);
+    return called;
+}
+
+// An object updated every Nth step reads the time since its own last update
+// from self.delta_time, game.delta_time only covers the current step
+void smc_object_elapsed(smc_game *g, uint32_t slot, solu_f64 dt) {
+    smc_object *o = g->records + slot;
+    if (o->activity.tt != SMC_ACTIVE_EVERY) return;
+    solu_f64 now = g->clock + dt;
+    solu_dobj_strset(o->obj.dyn, "delta_time", (solu_val){SOLU_TF64, .f64 = now - o->updated});
+    o->updated = now;
+}
+
+bool smc_object_active(smc_game *g, uint32_t slot, smc_frect view) {
+    smc_object *o = smc_object_at(g, slot);
+    if (!o) return false;
+    smc_activity *a = &o->activity;
+    if (a->tt == SMC_ACTIVE_ALWAYS)
+        return true;
+    // Staggered by slot so a crowd of every-Nth objects doesn't all land on one step
+    if (a->tt == SMC_ACTIVE_EVERY)
+        return (g->steps + slot) % a->every == 0;
+
+    solu_val x = solu_dobj_strget(o->obj.dyn, "x");
+    solu_val y = solu_dobj_strget(o->obj.dyn, "y");
+    if ((x.tt != SOLU_TF64 && x.tt != SOLU_TI64) || (y.tt != SOLU_TF64 && y.tt != SOLU_TI64))
+        return true; // Nowhere in particular
+    solu_f64 px = x.tt == SOLU_TF64 ? x.f64 : (solu_f64)x.i64;
+    solu_f64 py = y.tt == SOLU_TF64 ? y.f64 : (solu_f64)y.i64;
+    solu_f64 margin = a->tt == SMC_ACTIVE_NEAR ? a->range : 0;
+    return px >= view.x - margin && px <= view.x + view.width + margin
+        && py >= view.y - margin && py <= view.y + view.height + margin;
+}
+
+solu_call_ex smc_object_set(solu_state *s) {
+    solu_val self = solu_get(s, 0);
+    solu_val key = solu_get(s, 1);
+    solu_val val = solu_get(s, 2);
+    if (!solu_isdtype(self, SOLU_DOBJ))
+        return solu_panic(s, "arg 'self' expected obj got %s", solu_typename(self).c_str);
+    solu_dobj_set(s, self.dyn, key, val);
+
+    if (!solu_isdtype(key, SOLU_DSTR))
+        return solu_ok(val);
+    int index = 0;
+    smc_key k = smc_object_key(key.dyn, &index);
+    if (k == SMC_KEY_PLAIN)
+        return solu_ok(val);
+
+    smc_game *g = *(smc_game **)solu_capturec(s, 0).dyn;
+    // Positions are written constantly, skip the lookup while nothing has a body
+    if (k == SMC_KEY_BODY_FIELD && !g->bodies.count)
+        return solu_ok(val);
+    smc_object *o = smc_object_get(g, solu_dobj_strget(self.dyn, "id").i64);
+    if (!o || o->obj.dyn != self.dyn)
+        return solu_ok(val);
+    uint32_t slot = (uint32_t)(o - g->records);
+    switch (k) {
+        case SMC_KEY_BODY_FIELD: {
+            solu_f64 n;
+            if (o->body && smc_number(val, &n))
+                g->bodies.fields[index][o->body - 1] = n;
+            break;
+        }
+        case SMC_KEY_DEPTH: smc_object_depth(g, o); break;
+        case SMC_KEY_BODY: smc_object_body(g, slot); break;
+        case SMC_KEY_ACTIVITY: smc_object_activity(g, o); break;
+        case SMC_KEY_METHOD:
+            solu_drelease(o->methods[index]);
+            o->methods[index] = val;
+            solu_dhold(val);
+            smc_object_refresh(g, slot, (smc_method)index);
+            break;
+        case SMC_KEY_PLAIN: break;
+    }
+    return solu_ok(val);
+}
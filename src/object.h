@@ -0,0 +1,37 @@
+#ifndef OBJECT_H
+#define OBJECT_H
+
+#include "game.h"
+
+extern const char *const SMC_METHODS[SMC_METHOD_COUNT];
+
+// Object ids are handles, the slot in the low half and its generation above
+static inline solu_i64 smc_handle(uint32_t slot, uint32_t gen) {
+    return (solu_i64)(((uint64_t)gen << 32) | slot);
+}
+static inline uint32_t smc_handle_slot(solu_i64 id) {
+    return (uint32_t)((uint64_t)id & UINT32_MAX);
+}
+static inline uint32_t smc_handle_gen(solu_i64 id) {
+    return (uint32_t)((uint64_t)id >> 32);
+}
+
+smc_object *smc_object_at(smc_game *game, uint32_t slot);
+smc_object *smc_object_get(smc_game *game, solu_i64 id);
+void smc_object_reserve(smc_game *game, uint32_t count);
+solu_i64 smc_object_alloc(smc_game *game, solu_val obj);
+void smc_object_bind(smc_game *game, solu_val obj);
+void smc_object_release(smc_game *game, solu_i64 id);
+void smc_object_clear(smc_game *game);
+void smc_object_compact(smc_game *game, smc_method method);
+void smc_object_order(smc_game *game, smc_method method);
+
+void smc_object_start(smc_game *game, solu_val obj, solu_val fields);
+void smc_object_integrate(smc_game *game, solu_f64 dt);
+bool smc_callobject(smc_game *game, uint32_t slot, smc_method method);
+bool smc_object_active(smc_game *game, uint32_t slot, smc_frect view);
+void smc_object_elapsed(smc_game *game, uint32_t slot, solu_f64 dt);
+
+solu_call_ex smc_object_set(solu_state *state);
+
+#endif // OBJECT_H
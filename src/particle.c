@@ -0,0 +1,190 @@
+#include "particle.h"
+#include <stdlib.h>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SMC_LANES_NEON
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define SMC_LANES_SSE
+#endif
+
+// xorshift32 mapped to [-1, 1]
+static inline float smc_emitter_rand(smc_emitter *e) {
+    uint32_t x = e->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    e->seed = x;
+    return (float)(x >> 8) / (float)(1u << 23) - 1;
+}
+
+static void smc_emitter_grow(smc_emitter *e, uint32_t need) {
+    if (need <= e->cap) return;
+    uint32_t cap = e->cap ? e->cap : 64;
+    while (cap < need) cap *= 2;
+    float **cols[] = {&e->x, &e->y, &e->vx, &e->vy, &e->age, &e->life};
+    for (size_t i = 0; i < sizeof(cols) / sizeof(*cols); ++i) {
+        float *col = realloc(*cols[i], cap * sizeof(float));
+        if (!col) abort();
+        *cols[i] = col;
+    }
+    e->cap = cap;
+}
+
+// Capped at 'max' live particles, the overflow is dropped
+void smc_emitter_spawn(smc_emitter *e, uint32_t n) {
+    if (n > e->max - e->count) n = e->max - e->count;
+    if (!n) return;
+    smc_emitter_grow(e, e->count + n);
+    for (uint32_t i = e->count; i < e->count + n; ++i) {
+        e->x[i] = e->px;
+        e->y[i] = e->py;
+        e->vx[i] = e->vel[0] + e->spread[0] * smc_emitter_rand(e);
+        e->vy[i] = e->vel[1] + e->spread[1] * smc_emitter_rand(e);
+        e->age[i] = 0;
+        e->life[i] = e->lifetime + e->jitter * smc_emitter_rand(e);
+    }
+    e->count += n;
+}
+
+// Integrates n particles four lanes at a time. GCC won't vectorize float
+// math for ARMv7 NEON without -funsafe-math-optimizations, so the Vita build
+// needs the intrinsics spelled out, SSE gets the same for symmetry.
+static inline void smc_lanes_step(
+    float *restrict x, float *restrict y, float *restrict vx, float *restrict vy,
+    float *restrict age, float ax, float ay, float dt, uint32_t n
+) {
+    uint32_t i = 0;
+#if defined(SMC_LANES_NEON)
+    float32x4_t vax = vdupq_n_f32(ax), vay = vdupq_n_f32(ay), vdt = vdupq_n_f32(dt);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t nvx = vaddq_f32(vld1q_f32(vx + i), vax);
+        float32x4_t nvy = vaddq_f32(vld1q_f32(vy + i), vay);
+        vst1q_f32(vx + i, nvx);
+        vst1q_f32(vy + i, nvy);
+        vst1q_f32(x + i, vaddq_f32(vld1q_f32(x + i), vmulq_f32(nvx, vdt)));
+        vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vmulq_f32(nvy, vdt)));
+        vst1q_f32(age + i, vaddq_f32(vld1q_f32(age + i), vdt));
+    }
+#elif defined(SMC_LANES_SSE)
+    __m128 vax = _mm_set1_ps(ax), vay = _mm_set1_ps(ay), vdt = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4) {
+        __m128 nvx = _mm_add_ps(_mm_loadu_ps(vx + i), vax);
+        __m128 nvy = _mm_add_ps(_mm_loadu_ps(vy + i), vay);
+        _mm_storeu_ps(vx + i, nvx);
+        _mm_storeu_ps(vy + i, nvy);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(nvx, vdt)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(nvy, vdt)));
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), vdt));
+    }
+#endif
+    for (; i < n; ++i) {
+        vx[i] += ax;
+        vy[i] += ay;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        age[i] += dt;
+    }
+}
+
+static void smc_emitter_step(smc_emitter *e, float dt) {
+    e->accum += e->rate * dt;
+    if (e->accum >= 1) {
+        uint32_t n = (uint32_t)e->accum;
+        e->accum -= (float)n;
+        smc_emitter_spawn(e, n);
+    }
+
+    smc_lanes_step(e->x, e->y, e->vx, e->vy, e->age, e->gravity[0] * dt, e->gravity[1] * dt, dt, e->count);
+
+    for (uint32_t i = 0; i < e->count;) {
+        if (e->age[i] < e->life[i]) {
+            ++i;
+            continue;
+        }
+        uint32_t last = --e->count;
+        e->x[i] = e->x[last];
+        e->y[i] = e->y[last];
+        e->vx[i] = e->vx[last];
+        e->vy[i] = e->vy[last];
+        e->age[i] = e->age[last];
+        e->life[i] = e->life[last];
+    }
+}
+
+void smc_particles_add(smc_particles *p, smc_emitter *e) {
+    if (p->count == p->cap) {
+        uint32_t cap = p->cap ? p->cap * 2 : 16;
+        smc_emitter **data = realloc(p->data, cap * sizeof(smc_emitter *));
+        if (!data) abort();
+        p->data = data;
+        p->cap = cap;
+    }
+    e->owner = p;
+    e->index = p->count;
+    p->data[p->count++] = e;
+}
+
+void smc_particles_remove(smc_particles *p, smc_emitter *e) {
+    smc_emitter *last = p->data[--p->count];
+    p->data[e->index] = last;
+    last->index = e->index;
+    e->owner = NULL;
+}
+
+void smc_particles_step(smc_particles *p, float dt) {
+    for (uint32_t i = 0; i < p->count; ++i)
+        smc_emitter_step(p->data[i], dt);
+}
+
+// Emitters belong to their script handles, this only lets go of them
+void smc_particles_free(smc_particles *p) {
+    for (uint32_t i = 0; i < p->count; ++i) {
+        smc_emitter *e = p->data[i];
+        solu_drelease(e->sprite);
+        e->sprite = SOLU_NIL;
+        e->spr = NULL;
+        e->owner = NULL;
+    }
+    free(p->data);
+    *p = (smc_particles){0};
+}
+
+void smc_emitter_free(smc_emitter *e) {
+    if (e->owner)
+        smc_particles_remove(e->owner, e);
+    solu_drelease(e->sprite);
+    free(e->x);
+    free(e->y);
+    free(e->vx);
+    free(e->vy);
+    free(e->age);
+    free(e->life);
+    free(e);
+}
+
+// The whole emitter goes out as one geometry draw
+void smc_emitter_draw(smc_emitter *e, smc_renderer *r, float ox, float oy) {
+    if (!e->count || !e->spr || !e->spr->texture) return;
+    SDL_Vertex *v = smc_render_quads(r, e->spr->texture, e->count);
+
+    smc_rect f = e->frame;
+    float iw = 1.0f / (float)e->spr->texture->width, ih = 1.0f / (float)e->spr->texture->height;
+    float u0 = (float)f.x * iw, u1 = (float)(f.x + f.width) * iw;
+    float v0 = (float)f.y * ih, v1 = (float)(f.y + f.height) * ih;
+    float left = -(float)f.origin.x * e->scale, top = -(float)f.origin.y * e->scale;
+    float right = left + (float)f.width * e->scale, bottom = top + (float)f.height * e->scale;
+
+    for (uint32_t i = 0; i < e->count; ++i, v += 4) {
+        float x = e->x[i] - ox, y = e->y[i] - oy;
+        SDL_Color c = e->color;
+        if (e->fade) {
+            float t = 1 - e->age[i] / e->life[i];
+            c.a = (uint8_t)((float)c.a * (t < 0 ? 0 : t));
+        }
+        v[0] = (SDL_Vertex){{x + left, y + top}, c, {u0, v0}};
+        v[1] = (SDL_Vertex){{x + right, y + top}, c, {u1, v0}};
+        v[2] = (SDL_Vertex){{x + right, y + bottom}, c, {u1, v1}};
+        v[3] = (SDL_Vertex){{x + left, y + bottom}, c, {u0, v1}};
+    }
+}
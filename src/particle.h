@@ -0,0 +1,48 @@
+#ifndef PARTICLE_H
+#define PARTICLE_H
+
+#include "asset.h"
+#include "render.h"
+#include <solus/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Live particles as one packed column per field, dead ones are swapped out
+// at the end of each step so the columns stay dense
+typedef struct smc_emitter {
+    float *x, *y, *vx, *vy, *age, *life;
+    uint32_t count, cap, max;
+
+    float px, py;           // Spawn point
+    float rate, accum;      // Particles per second, fraction carried over
+    float lifetime, jitter; // Seconds, +- jitter
+    float vel[2], spread[2]; // Launch velocity, +- spread per axis
+    float gravity[2];
+    float scale;
+    SDL_Color color;
+    bool fade; // Alpha follows remaining life
+    uint32_t seed;
+
+    solu_val sprite; // Held so the texture outlives the emitter
+    smc_spritedata *spr;
+    smc_rect frame;
+
+    struct smc_particles *owner;
+    uint32_t index;
+} smc_emitter;
+
+typedef struct smc_particles {
+    smc_emitter **data;
+    uint32_t count, cap;
+} smc_particles;
+
+void smc_particles_add(smc_particles *p, smc_emitter *e);
+void smc_particles_remove(smc_particles *p, smc_emitter *e);
+void smc_particles_step(smc_particles *p, float dt);
+void smc_particles_free(smc_particles *p);
+
+void smc_emitter_spawn(smc_emitter *e, uint32_t n);
+void smc_emitter_free(smc_emitter *e);
+void smc_emitter_draw(smc_emitter *e, smc_renderer *r, float ox, float oy);
+
+#endif // PARTICLE_H
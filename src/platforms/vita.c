@@ -5,6 +5,8 @@
 #include <solus/val.h>
 #include <sf/math.h>
 #include <sf/fs.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include "platforms.h"
 #include "solus/compat.h"
@@ -106,12 +108,22 @@ char *smc_locate_manifest(void) {
     return strdup("app0:/manifest.solu");
 }
 
+// The title's data dir doesn't exist until something creates it, returns
+// NULL when either level can't be made so callers can go without
 char *smc_make_dir(char *path) {
-    char *p = sf_str_fmt("ux0:/data/" VITA_TITLEID "/%s", path).c_str;
+    char *root = "ux0:/data/" VITA_TITLEID;
+    if (!sf_file_exists(sf_ref(root)) && (mkdir(root, 0700) || !sf_file_exists(sf_ref(root)))) {
+        smc_err("Failed to create dir %s: %s", root, strerror(errno));
+        return NULL;
+    }
+    char *p = sf_str_fmt("%s/%s", root, path).c_str;
     if (!sf_file_exists(sf_ref(p))) {
         int status = mkdir(p, 0700);
-        if (status || !sf_file_exists(sf_ref(p)))
-            smc_err("Failed to create dir: %s", strerror(errno));
+        if (status || !sf_file_exists(sf_ref(p))) {
+            smc_err("Failed to create dir %s: %s", p, strerror(errno));
+            free(p);
+            return NULL;
+        }
     }
     return p;
 }
@@ -0,0 +1,497 @@
+#include "render.h"
+#include "platforms/platforms.h"
+#include <math.h>
+#include <stdlib.h>
+
+static inline smc_cmd *smc_cmd_push(smc_cmdbuf *buf) {
+    if (buf->count == buf->cap) {
+        uint32_t cap = buf->cap ? buf->cap * 2 : 256;
+        smc_cmd *data = realloc(buf->data, cap * sizeof(smc_cmd));
+        if (!data) abort();
+        buf->data = data;
+        buf->cap = cap;
+    }
+    return buf->data + buf->count++;
+}
+
+static inline void smc_cmdbuf_reset(smc_cmdbuf *buf) {
+    buf->count = buf->vert_c = buf->index_c = 0;
+}
+
+static inline void smc_cmdbuf_free(smc_cmdbuf *buf) {
+    free(buf->data);
+    free(buf->verts);
+    free(buf->indices);
+}
+
+static inline void smc_texture_release(smc_texture *t) {
+    if (t->texture) SDL_DestroyTexture(t->texture);
+    if (t->surface) SDL_FreeSurface(t->surface);
+    free(t);
+}
+
+// Every texture draws through geometry with the tint in its vertices, so
+// its own modulation is set once and never changes
+static inline void smc_texture_state(smc_renderer *r, smc_texture *t) {
+    SDL_SetTextureColorMod(t->texture, 255, 255, 255);
+    SDL_SetTextureAlphaMod(t->texture, 255);
+    SDL_SetTextureBlendMode(t->texture, SDL_BLENDMODE_BLEND);
+    t->blend = SDL_BLENDMODE_BLEND;
+    r->frame.state_changes += 3;
+}
+
+// Draws into a target texture replace its pixels rather than blend over the
+// cleared (0,0,0,0), or translucent texels would be weighted by alpha again
+// when the target is itself drawn to the screen
+static inline void smc_texture_blend(smc_renderer *r, smc_texture *t) {
+    SDL_BlendMode blend = r->target == r->screen ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE;
+    if (t->blend == blend) {
+        ++r->frame.state_skips;
+        return;
+    }
+    SDL_SetTextureBlendMode(t->texture, blend);
+    t->blend = blend;
+    ++r->frame.state_changes;
+}
+
+static inline void smc_state_color(smc_renderer *r, SDL_Color c) {
+    if (r->state_valid && r->draw_color.r == c.r && r->draw_color.g == c.g
+        && r->draw_color.b == c.b && r->draw_color.a == c.a) {
+        ++r->frame.state_skips;
+        return;
+    }
+    SDL_SetRenderDrawColor(r->ren, c.r, c.g, c.b, c.a);
+    r->draw_color = c;
+    ++r->frame.state_changes;
+}
+
+static inline void smc_state_blend(smc_renderer *r, SDL_BlendMode blend) {
+    if (r->state_valid && r->draw_blend == blend) {
+        ++r->frame.state_skips;
+        return;
+    }
+    SDL_SetRenderDrawBlendMode(r->ren, blend);
+    r->draw_blend = blend;
+    ++r->frame.state_changes;
+}
+
+static inline void smc_state_target(smc_renderer *r, SDL_Texture *target) {
+    if (r->state_valid && r->target == target) {
+        ++r->frame.state_skips;
+        return;
+    }
+    SDL_SetRenderTarget(r->ren, target);
+    r->target = target;
+    ++r->frame.state_changes;
+}
+
+static inline SDL_Texture *smc_texture_upload(smc_renderer *r, smc_texture *t) {
+    if (!t->texture && (t->target || t->page)) {
+        t->texture = SDL_CreateTexture(
+            r->ren,
+            t->page ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGBA8888,
+            t->page ? SDL_TEXTUREACCESS_STATIC : SDL_TEXTUREACCESS_TARGET,
+            t->width, t->height
+        );
+        if (!t->texture) {
+            smc_err("Failed to create texture: %s", SDL_GetError());
+            return NULL;
+        }
+        SDL_SetTextureScaleMode(t->texture, SDL_ScaleModeNearest);
+        smc_texture_state(r, t);
+    }
+    if (!t->texture && t->surface) {
+        t->texture = SDL_CreateTextureFromSurface(r->ren, t->surface);
+        if (!t->texture) {
+            smc_err("Failed to upload texture: %s", SDL_GetError());
+            return NULL;
+        }
+        SDL_SetTextureScaleMode(t->texture, SDL_ScaleModeNearest);
+        smc_texture_state(r, t);
+        SDL_FreeSurface(t->surface);
+        t->surface = NULL;
+    }
+    return t->texture;
+}
+
+static bool smc_render_create(smc_renderer *r) {
+    r->ren = SDL_CreateRenderer(
+        r->win, -1,
+        SDL_RENDERER_ACCELERATED | (r->vsync ? SDL_RENDERER_PRESENTVSYNC : 0)
+    );
+    if (!r->ren) {
+        smc_err("SDL_CreateRenderer Error: %s", SDL_GetError());
+        return false;
+    }
+    r->screen = SDL_CreateTexture(
+        r->ren,
+        SDL_PIXELFORMAT_RGBA8888,
+        SDL_TEXTUREACCESS_TARGET,
+        r->width,
+        r->height
+    );
+    if (!r->screen) {
+        smc_err("SDL_CreateTexture Error: %s", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureScaleMode(r->screen, SDL_ScaleModeNearest);
+    return true;
+}
+
+// Frees are the only commands honoured once the renderer is shutting down
+static void smc_render_destroy(smc_renderer *r) {
+    for (uint32_t b = 0; b < 2; ++b) {
+        smc_cmdbuf *buf = &r->bufs[b];
+        for (smc_cmd *cmd = buf->data; cmd < buf->data + buf->count; ++cmd)
+            if (cmd->tt == SMC_CMD_FREE) smc_texture_release(cmd->free);
+            else if (cmd->tt == SMC_CMD_UPLOAD) SDL_FreeSurface(cmd->upload.pixels);
+        smc_cmdbuf_reset(buf);
+    }
+    if (r->screen) SDL_DestroyTexture(r->screen);
+    if (r->ren) SDL_DestroyRenderer(r->ren);
+    r->screen = NULL;
+    r->ren = NULL;
+}
+
+static void smc_render_execute(smc_renderer *r, smc_cmdbuf *buf) {
+    // The present below leaves SDL's state behind, the cache restarts each frame
+    r->frame = (smc_render_stats){0};
+    r->state_valid = false;
+    smc_state_target(r, r->screen);
+    smc_state_color(r, r->clear_color);
+    r->state_valid = true;
+    SDL_RenderClear(r->ren);
+    ++r->frame.draws;
+    for (smc_cmd *cmd = buf->data; cmd < buf->data + buf->count; ++cmd) {
+        switch (cmd->tt) {
+            case SMC_CMD_RECT:
+                smc_state_blend(r, SDL_BLENDMODE_BLEND);
+                smc_state_color(r, cmd->color);
+                SDL_RenderFillRect(r->ren, &cmd->rect);
+                ++r->frame.draws;
+                break;
+            case SMC_CMD_GEOMETRY: {
+                SDL_Texture *tex = smc_texture_upload(r, cmd->geometry.texture);
+                if (!tex) break;
+                smc_texture_blend(r, cmd->geometry.texture);
+                ++r->frame.draws;
+                ++r->frame.flushes;
+                r->frame.quads += cmd->geometry.vert_c / 4;
+                SDL_RenderGeometry(
+                    r->ren, tex,
+                    buf->verts + cmd->geometry.vert, (int)cmd->geometry.vert_c,
+                    buf->indices + cmd->geometry.index, (int)cmd->geometry.index_c
+                );
+                break;
+            }
+            case SMC_CMD_TARGET: {
+                SDL_Texture *tex = cmd->target ? smc_texture_upload(r, cmd->target) : NULL;
+                if (cmd->target && !tex) break;
+                smc_state_target(r, tex ? tex : r->screen);
+                if (tex) {
+                    // Targets are always redrawn from scratch
+                    smc_state_color(r, (SDL_Color){0, 0, 0, 0});
+                    SDL_RenderClear(r->ren);
+                    ++r->frame.draws;
+                }
+                break;
+            }
+            case SMC_CMD_UPLOAD: {
+                SDL_Surface *px = cmd->upload.pixels;
+                SDL_Texture *tex = smc_texture_upload(r, cmd->upload.texture);
+                if (tex) SDL_UpdateTexture(
+                    tex, &(SDL_Rect){cmd->upload.at.x, cmd->upload.at.y, px->w, px->h},
+                    px->pixels, px->pitch
+                );
+                SDL_FreeSurface(px);
+                break;
+            }
+            case SMC_CMD_FREE:
+                smc_texture_release(cmd->free);
+                break;
+        }
+    }
+    smc_cmdbuf_reset(buf);
+    SDL_SetRenderTarget(r->ren, NULL);
+    r->state_valid = false;
+
+    // Draw screen to window
+    int winW, winH;
+    SDL_GetRendererOutputSize(r->ren, &winW, &winH);
+    float scaleX = (float)winW / (float)r->width;
+    float scaleY = (float)winH / (float)r->height;
+    float scale = scaleX < scaleY ? scaleX : scaleY;
+    int dw = (int)((float)r->width * scale);
+    int dh = (int)((float)r->height * scale);
+
+    SDL_SetRenderDrawColor(r->ren, 0, 0, 0, 255);
+    SDL_RenderClear(r->ren);
+    SDL_RenderCopy(r->ren, r->screen, NULL, &(SDL_Rect){
+        (winW - dw) / 2,
+        (winH - dh) / 2,
+        dw,
+        dh
+    });
+    SDL_RenderPresent(r->ren);
+}
+
+#ifdef SMC_EXPERIMENTAL_RENDER_THREAD
+static int smc_render_thread(void *ud) {
+    smc_renderer *r = ud;
+    bool ok = smc_render_create(r);
+    SDL_LockMutex(r->lock);
+    r->ok = ok;
+    r->ready = true;
+    SDL_CondBroadcast(r->cond);
+    SDL_UnlockMutex(r->lock);
+
+    while (ok) {
+        SDL_LockMutex(r->lock);
+        while (!r->pending && !r->quit)
+            SDL_CondWait(r->cond, r->lock);
+        if (!r->pending) {
+            SDL_UnlockMutex(r->lock);
+            break;
+        }
+        smc_cmdbuf *buf = &r->bufs[r->submit];
+        SDL_UnlockMutex(r->lock);
+
+        smc_render_execute(r, buf);
+
+        SDL_LockMutex(r->lock);
+        r->stats = r->frame;
+        r->pending = false;
+        SDL_CondBroadcast(r->cond);
+        SDL_UnlockMutex(r->lock);
+    }
+    smc_render_destroy(r);
+    return ok ? 0 : -1;
+}
+#endif
+
+bool smc_render_init(smc_renderer *r, SDL_Window *win, int width, int height, bool vsync, bool threaded) {
+    r->win = win;
+    r->width = width;
+    r->height = height;
+    r->vsync = vsync;
+#ifndef SMC_EXPERIMENTAL_RENDER_THREAD
+    threaded = false;
+#endif
+    r->threaded = threaded;
+    r->record = 0;
+    r->submit = 1;
+
+    if (!threaded) {
+        if (!smc_render_create(r)) {
+            smc_render_destroy(r);
+            return false;
+        }
+        return (r->active = true);
+    }
+
+#ifdef SMC_EXPERIMENTAL_RENDER_THREAD
+    r->lock = SDL_CreateMutex();
+    r->cond = SDL_CreateCond();
+    if (!r->lock || !r->cond) {
+        smc_err("Failed to create render thread sync: %s", SDL_GetError());
+        return false;
+    }
+    r->thread = SDL_CreateThread(smc_render_thread, "render", r);
+    if (!r->thread) {
+        smc_err("Failed to create render thread: %s", SDL_GetError());
+        return false;
+    }
+
+    SDL_LockMutex(r->lock);
+    while (!r->ready)
+        SDL_CondWait(r->cond, r->lock);
+    SDL_UnlockMutex(r->lock);
+    if (!r->ok) {
+        SDL_WaitThread(r->thread, NULL);
+        r->thread = NULL;
+        return false;
+    }
+    return (r->active = true);
+#else
+    return false;
+#endif
+}
+
+void smc_render_free(smc_renderer *r) {
+#ifdef SMC_EXPERIMENTAL_RENDER_THREAD
+    if (r->thread) {
+        SDL_LockMutex(r->lock);
+        r->quit = true;
+        SDL_CondBroadcast(r->cond);
+        SDL_UnlockMutex(r->lock);
+        SDL_WaitThread(r->thread, NULL);
+        r->thread = NULL;
+    } else smc_render_destroy(r);
+
+    if (r->cond) SDL_DestroyCond(r->cond);
+    if (r->lock) SDL_DestroyMutex(r->lock);
+#else
+    smc_render_destroy(r);
+#endif
+    smc_cmdbuf_free(&r->bufs[0]);
+    smc_cmdbuf_free(&r->bufs[1]);
+    *r = (smc_renderer){0};
+}
+
+void smc_render_submit(smc_renderer *r) {
+    if (!r->active) return;
+    if (!r->threaded) {
+        smc_render_execute(r, &r->bufs[r->record]);
+        r->shown = r->stats = r->frame;
+        return;
+    }
+
+#ifdef SMC_EXPERIMENTAL_RENDER_THREAD
+    // Frame N is handed over as soon as N-1 has been presented
+    SDL_LockMutex(r->lock);
+    while (r->pending)
+        SDL_CondWait(r->cond, r->lock);
+    r->shown = r->stats;
+    r->submit = r->record;
+    r->record ^= 1;
+    r->pending = true;
+    SDL_CondBroadcast(r->cond);
+    SDL_UnlockMutex(r->lock);
+#endif
+}
+
+smc_texture *smc_texture_new(SDL_Surface *surface) {
+    smc_texture *t = malloc(sizeof(smc_texture));
+    if (!t) return NULL;
+    *t = (smc_texture){.surface = surface, .width = surface->w, .height = surface->h};
+    return t;
+}
+
+smc_texture *smc_texture_target(int width, int height) {
+    smc_texture *t = malloc(sizeof(smc_texture));
+    if (!t) return NULL;
+    *t = (smc_texture){.width = width, .height = height, .target = true};
+    return t;
+}
+
+smc_texture *smc_texture_page(int width, int height) {
+    smc_texture *t = malloc(sizeof(smc_texture));
+    if (!t) return NULL;
+    *t = (smc_texture){.width = width, .height = height, .page = true};
+    return t;
+}
+
+void smc_texture_free(smc_renderer *r, smc_texture *texture) {
+    if (!texture) return;
+    if (!r->active) {
+        smc_texture_release(texture);
+        return;
+    }
+    // Earlier commands may still reference it, release in submission order
+    smc_cmd *cmd = smc_cmd_push(&r->bufs[r->record]);
+    *cmd = (smc_cmd){.tt = SMC_CMD_FREE, .free = texture};
+}
+
+void smc_render_sprite(
+    smc_renderer *r, smc_texture *texture,
+    SDL_Rect source, SDL_FRect dest, double rot, SDL_FPoint origin,
+    SDL_RendererFlip flip, SDL_Color color
+) {
+    if (!texture) return;
+    float iw = texture->width ? 1.0f / (float)texture->width : 0;
+    float ih = texture->height ? 1.0f / (float)texture->height : 0;
+    float u0 = (float)source.x * iw, u1 = (float)(source.x + source.w) * iw;
+    float v0 = (float)source.y * ih, v1 = (float)(source.y + source.h) * ih;
+    if (flip & SDL_FLIP_HORIZONTAL) { float u = u0; u0 = u1; u1 = u; }
+    if (flip & SDL_FLIP_VERTICAL) { float v = v0; v0 = v1; v1 = v; }
+
+    SDL_FPoint corners[4] = {
+        {dest.x, dest.y},
+        {dest.x + dest.w, dest.y},
+        {dest.x + dest.w, dest.y + dest.h},
+        {dest.x, dest.y + dest.h},
+    };
+    // Clockwise about dest + origin, as SDL_RenderCopyEx does
+    if (rot != 0) {
+        float rad = (float)(rot * 0.017453292519943295); // Degrees
+        float c = cosf(rad), s = sinf(rad);
+        float px = dest.x + origin.x, py = dest.y + origin.y;
+        for (int i = 0; i < 4; ++i) {
+            float dx = corners[i].x - px, dy = corners[i].y - py;
+            corners[i] = (SDL_FPoint){px + dx * c - dy * s, py + dx * s + dy * c};
+        }
+    }
+
+    SDL_Vertex *v = smc_render_quads(r, texture, 1);
+    v[0] = (SDL_Vertex){corners[0], color, {u0, v0}};
+    v[1] = (SDL_Vertex){corners[1], color, {u1, v0}};
+    v[2] = (SDL_Vertex){corners[2], color, {u1, v1}};
+    v[3] = (SDL_Vertex){corners[3], color, {u0, v1}};
+}
+
+void smc_render_rect(smc_renderer *r, SDL_Rect rect, SDL_Color color) {
+    smc_cmd *cmd = smc_cmd_push(&r->bufs[r->record]);
+    *cmd = (smc_cmd){.tt = SMC_CMD_RECT, .color = color, .rect = rect};
+}
+
+// Commands up to the next target change draw into 'target'
+void smc_render_target(smc_renderer *r, smc_texture *target) {
+    smc_cmd *cmd = smc_cmd_push(&r->bufs[r->record]);
+    *cmd = (smc_cmd){.tt = SMC_CMD_TARGET, .target = target};
+}
+
+// Copies into a page texture ahead of any draw recorded after it
+void smc_render_upload(smc_renderer *r, smc_texture *texture, SDL_Surface *pixels, SDL_Point at) {
+    smc_cmd *cmd = smc_cmd_push(&r->bufs[r->record]);
+    *cmd = (smc_cmd){.tt = SMC_CMD_UPLOAD, .upload = {texture, pixels, at}};
+}
+
+// Reserves 'quads' textured quads, the caller fills in four vertices per
+// quad in top-left, top-right, bottom-right, bottom-left order
+SDL_Vertex *smc_render_quads(smc_renderer *r, smc_texture *texture, uint32_t quads) {
+    smc_cmdbuf *buf = &r->bufs[r->record];
+    uint32_t vert_c = quads * 4, index_c = quads * 6;
+    if (buf->vert_c + vert_c > buf->vert_cap) {
+        uint32_t cap = buf->vert_cap ? buf->vert_cap : 1024;
+        while (cap < buf->vert_c + vert_c) cap *= 2;
+        SDL_Vertex *verts = realloc(buf->verts, cap * sizeof(SDL_Vertex));
+        if (!verts) abort();
+        buf->verts = verts;
+        buf->vert_cap = cap;
+    }
+    if (buf->index_c + index_c > buf->index_cap) {
+        uint32_t cap = buf->index_cap ? buf->index_cap : 1536;
+        while (cap < buf->index_c + index_c) cap *= 2;
+        int *indices = realloc(buf->indices, cap * sizeof(int));
+        if (!indices) abort();
+        buf->indices = indices;
+        buf->index_cap = cap;
+    }
+
+    // Joins the previous draw when nothing has come between them, indices
+    // are relative to the command's first vertex
+    int base = 0;
+    smc_cmd *cmd = buf->count ? buf->data + buf->count - 1 : NULL;
+    if (cmd && cmd->tt == SMC_CMD_GEOMETRY && cmd->geometry.texture == texture) {
+        base = (int)cmd->geometry.vert_c;
+        cmd->geometry.vert_c += vert_c;
+        cmd->geometry.index_c += index_c;
+    } else {
+        cmd = smc_cmd_push(buf);
+        *cmd = (smc_cmd){
+            .tt = SMC_CMD_GEOMETRY,
+            .geometry = {texture, buf->vert_c, vert_c, buf->index_c, index_c},
+        };
+    }
+    int *index = buf->indices + buf->index_c;
+    for (int q = 0; q < (int)quads; ++q) {
+        int v = base + q * 4;
+        *index++ = v; *index++ = v + 1; *index++ = v + 2;
+        *index++ = v; *index++ = v + 2; *index++ = v + 3;
+    }
+
+    SDL_Vertex *out = buf->verts + buf->vert_c;
+    buf->vert_c += vert_c;
+    buf->index_c += index_c;
+    return out;
+}
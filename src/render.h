@@ -0,0 +1,119 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Pixels are handed over as a surface and uploaded by whichever thread owns
+// the renderer, after which the surface is released. Targets are created
+// empty at their size instead, geometry drawn into them is copied without
+// blending so it only blends once when the target reaches the screen.
+typedef struct {
+    SDL_Surface *surface;
+    SDL_Texture *texture;
+    int width, height; // Kept for texture coordinates once the surface is gone
+    bool target;       // Created empty as a render target
+    bool page;         // Created empty and filled by upload commands
+    SDL_BlendMode blend; // Last applied by the executing thread
+} smc_texture;
+
+typedef enum {
+    SMC_CMD_RECT,
+    SMC_CMD_GEOMETRY,
+    SMC_CMD_TARGET,
+    SMC_CMD_UPLOAD,
+    SMC_CMD_FREE,
+} smc_cmd_type;
+
+typedef struct {
+    smc_cmd_type tt;
+    SDL_Color color;
+    union {
+        SDL_Rect rect;
+        struct {
+            smc_texture *texture;
+            uint32_t vert, vert_c; // Range of the buffer's vertices
+            uint32_t index, index_c;
+        } geometry;
+        smc_texture *target; // NULL returns to the screen
+        struct {
+            smc_texture *texture;
+            SDL_Surface *pixels; // RGBA32, freed once copied
+            SDL_Point at;
+        } upload;
+        smc_texture *free;
+    };
+} smc_cmd;
+
+// Geometry commands index into vertex and index arrays owned by the buffer
+typedef struct {
+    smc_cmd *data;
+    uint32_t count, cap;
+    SDL_Vertex *verts;
+    uint32_t vert_c, vert_cap;
+    int *indices;
+    uint32_t index_c, index_cap;
+} smc_cmdbuf;
+
+// Per presented frame. State changes are what reached SDL, skips were
+// dropped by the renderer's state cache as already in effect.
+typedef struct {
+    uint32_t draws;   // Geometry, rect and clear calls
+    uint32_t flushes; // Geometry batches
+    uint32_t quads;
+    uint32_t state_changes, state_skips;
+} smc_render_stats;
+
+// Draw calls are recorded into command buffers and executed at submit. Builds
+// with SMC_EXPERIMENTAL_RENDER_THREAD can instead record one buffer while a
+// dedicated thread submits the other, which SDL does not support and no
+// shipped target enables. Sprites become quads appended to
+// the previous geometry command while it uses the same texture, and a
+// texture change, rect or target switch starts a new one.
+typedef struct {
+    bool active, threaded, vsync;
+    SDL_Window *win;
+    SDL_Renderer *ren;
+    SDL_Texture *screen;
+    int width, height;
+    SDL_Color clear_color;
+
+    smc_cmdbuf bufs[2];
+    uint32_t record, submit;
+
+    // Owned by whichever thread executes, 'shown' is the main thread's copy
+    SDL_Color draw_color;
+    SDL_BlendMode draw_blend;
+    SDL_Texture *target;
+    bool state_valid;
+    smc_render_stats frame, stats, shown;
+
+#ifdef SMC_EXPERIMENTAL_RENDER_THREAD
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    bool ready, ok, pending, quit;
+#endif
+} smc_renderer;
+
+bool smc_render_init(smc_renderer *r, SDL_Window *win, int width, int height, bool vsync, bool threaded);
+void smc_render_free(smc_renderer *r);
+void smc_render_submit(smc_renderer *r);
+
+smc_texture *smc_texture_new(SDL_Surface *surface);
+smc_texture *smc_texture_target(int width, int height);
+smc_texture *smc_texture_page(int width, int height);
+void smc_texture_free(smc_renderer *r, smc_texture *texture);
+
+void smc_render_sprite(
+    smc_renderer *r, smc_texture *texture,
+    SDL_Rect source, SDL_FRect dest, double rot, SDL_FPoint origin,
+    SDL_RendererFlip flip, SDL_Color color
+);
+void smc_render_rect(smc_renderer *r, SDL_Rect rect, SDL_Color color);
+void smc_render_target(smc_renderer *r, smc_texture *target);
+void smc_render_upload(smc_renderer *r, smc_texture *texture, SDL_Surface *pixels, SDL_Point at);
+SDL_Vertex *smc_render_quads(smc_renderer *r, smc_texture *texture, uint32_t quads);
+
+#endif // RENDER_H
@@ -0,0 +1,93 @@
+#include "tilemap.h"
+#include <math.h>
+#include <stdlib.h>
+
+static const SDL_Color smc_white = {255, 255, 255, 255};
+
+void smc_layer_set(smc_layer *l, uint32_t tx, uint32_t ty, int32_t tile) {
+    int32_t *t = l->tiles + ty * l->width + tx;
+    if (*t == tile) return;
+    *t = tile;
+    l->chunks[(ty / SMC_CHUNK_TILES) * l->chunk_w + tx / SMC_CHUNK_TILES].dirty = true;
+}
+
+static void smc_chunk_bake(smc_layer *l, smc_renderer *r, uint32_t cx, uint32_t cy) {
+    smc_chunk *c = l->chunks + cy * l->chunk_w + cx;
+    if (!c->texture) {
+        c->texture = smc_texture_target(
+            (int)(l->tile_w * SMC_CHUNK_TILES),
+            (int)(l->tile_h * SMC_CHUNK_TILES)
+        );
+        if (!c->texture) return;
+    }
+    c->dirty = false;
+
+    smc_render_target(r, c->texture);
+    uint32_t x0 = cx * SMC_CHUNK_TILES, y0 = cy * SMC_CHUNK_TILES;
+    for (uint32_t ty = y0; ty < y0 + SMC_CHUNK_TILES && ty < l->height; ++ty) {
+        for (uint32_t tx = x0; tx < x0 + SMC_CHUNK_TILES && tx < l->width; ++tx) {
+            int32_t tile = l->tiles[ty * l->width + tx];
+            if (tile < 0 || (uint32_t)tile >= l->spr->frame_c) continue;
+            smc_rect f = l->spr->frames[tile];
+            smc_render_sprite(
+                r, l->spr->texture,
+                (SDL_Rect){(int)f.x, (int)f.y, (int)f.width, (int)f.height},
+                (SDL_FRect){
+                    (float)((tx - x0) * l->tile_w),
+                    (float)((ty - y0) * l->tile_h),
+                    (float)f.width, (float)f.height
+                },
+                0, (SDL_FPoint){0, 0}, SDL_FLIP_NONE, smc_white
+            );
+        }
+    }
+    smc_render_target(r, NULL);
+}
+
+// Target contents don't survive a renderer reset, every chunk bakes again
+// the next time it is on screen
+void smc_layer_invalidate(smc_layer *l) {
+    for (uint32_t i = 0; i < l->chunk_w * l->chunk_h; ++i)
+        l->chunks[i].dirty = true;
+}
+
+// One copy per visible chunk, chunks off screen are neither baked nor drawn
+void smc_layer_draw(smc_layer *l, smc_renderer *r, smc_frect view) {
+    if (!l->spr || !l->spr->texture) return;
+    solu_f64 cw = (solu_f64)(l->tile_w * SMC_CHUNK_TILES);
+    solu_f64 ch = (solu_f64)(l->tile_h * SMC_CHUNK_TILES);
+    solu_f64 lx = view.x - l->x, ly = view.y - l->y;
+    solu_f64 x0 = floor(lx / cw), y0 = floor(ly / ch);
+    solu_f64 x1 = floor((lx + view.width) / cw), y1 = floor((ly + view.height) / ch);
+    if (x1 < 0 || y1 < 0 || x0 >= l->chunk_w || y0 >= l->chunk_h) return;
+    uint32_t cx0 = x0 < 0 ? 0 : (uint32_t)x0, cy0 = y0 < 0 ? 0 : (uint32_t)y0;
+    uint32_t cx1 = x1 >= l->chunk_w ? l->chunk_w - 1 : (uint32_t)x1;
+    uint32_t cy1 = y1 >= l->chunk_h ? l->chunk_h - 1 : (uint32_t)y1;
+
+    for (uint32_t cy = cy0; cy <= cy1; ++cy) {
+        for (uint32_t cx = cx0; cx <= cx1; ++cx) {
+            smc_chunk *c = l->chunks + cy * l->chunk_w + cx;
+            if (c->dirty) smc_chunk_bake(l, r, cx, cy);
+            if (!c->texture) continue;
+            smc_render_sprite(
+                r, c->texture,
+                (SDL_Rect){0, 0, (int)cw, (int)ch},
+                (SDL_FRect){
+                    (float)((solu_f64)l->x + cx * cw - view.x),
+                    (float)((solu_f64)l->y + cy * ch - view.y),
+                    (float)cw, (float)ch
+                },
+                0, (SDL_FPoint){0, 0}, SDL_FLIP_NONE, smc_white
+            );
+        }
+    }
+}
+
+void smc_layer_free(smc_renderer *r, smc_layer *l) {
+    for (uint32_t i = 0; i < l->chunk_w * l->chunk_h; ++i)
+        smc_texture_free(r, l->chunks[i].texture);
+    free(l->chunks);
+    free(l->tiles);
+    sf_str_free(l->name);
+    solu_drelease(l->sprite);
+}
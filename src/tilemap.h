@@ -0,0 +1,39 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "asset.h"
+#include "render.h"
+#include <solus/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SMC_CHUNK_TILES 16 // Chunks are square, this many tiles a side
+
+// Baked lazily the first time it is on screen and again after any of its
+// tiles change
+typedef struct {
+    smc_texture *texture;
+    bool dirty;
+} smc_chunk;
+
+// Tile layer from a room's 'layers', tiles are frame indices into the
+// tileset sprite and anything negative is empty
+typedef struct {
+    sf_str name;
+    solu_val sprite; // Held so the tileset outlives the room
+    smc_spritedata *spr;
+    int32_t *tiles;
+    uint32_t width, height;   // In tiles
+    uint32_t tile_w, tile_h;  // Grid pitch, from the tileset's first frame
+    uint32_t chunk_w, chunk_h;
+    smc_chunk *chunks;
+    float x, y;
+    solu_f64 depth;
+} smc_layer;
+
+void smc_layer_set(smc_layer *l, uint32_t tx, uint32_t ty, int32_t tile);
+void smc_layer_draw(smc_layer *l, smc_renderer *r, smc_frect view);
+void smc_layer_invalidate(smc_layer *l);
+void smc_layer_free(smc_renderer *r, smc_layer *l);
+
+#endif // TILEMAP_H
@@ -0,0 +1,154 @@
+#include "timer.h"
+#include <stdlib.h>
+
+static inline smc_timer *smc_wheel_get(smc_wheel *w, solu_i64 handle) {
+    uint32_t i = (uint32_t)((uint64_t)handle & UINT32_MAX);
+    uint32_t gen = (uint32_t)((uint64_t)handle >> 32);
+    if (i >= w->count) return NULL;
+    smc_timer *t = w->timers + i;
+    return t->active && t->gen == gen ? t : NULL;
+}
+
+static void smc_wheel_link(smc_wheel *w, uint32_t i) {
+    smc_timer *t = w->timers + i;
+    // The level is picked by the highest byte where expiry and now differ, so
+    // a bucket is always cascaded exactly when its window comes up
+    uint64_t diff = t->expires ^ w->now;
+    uint32_t level = 0;
+    while (level < SMC_WHEEL_LEVELS && diff >> (SMC_WHEEL_BITS * (level + 1)))
+        ++level;
+    t->bucket = (uint16_t)(level < SMC_WHEEL_LEVELS
+        ? level * SMC_WHEEL_SLOTS + ((t->expires >> (SMC_WHEEL_BITS * level)) & SMC_WHEEL_MASK)
+        : SMC_WHEEL_BUCKETS - 1);
+
+    uint32_t *head = &w->buckets[t->bucket];
+    t->prev = 0;
+    t->next = *head;
+    if (*head) w->timers[*head - 1].prev = i + 1;
+    *head = i + 1;
+}
+
+static void smc_wheel_unlink(smc_wheel *w, uint32_t i) {
+    smc_timer *t = w->timers + i;
+    if (t->bucket == SMC_WHEEL_UNLINKED) return;
+    if (t->prev) w->timers[t->prev - 1].next = t->next;
+    else w->buckets[t->bucket] = t->next;
+    if (t->next) w->timers[t->next - 1].prev = t->prev;
+    t->next = t->prev = 0;
+    t->bucket = SMC_WHEEL_UNLINKED;
+}
+
+static void smc_wheel_release(smc_wheel *w, uint32_t i) {
+    smc_timer *t = w->timers + i;
+    smc_wheel_unlink(w, i);
+    solu_drelease(t->fn);
+    t->fn = SOLU_NIL;
+    t->active = false;
+    ++t->gen;
+    t->next = w->free_head;
+    w->free_head = i + 1;
+    --w->pending;
+}
+
+solu_i64 smc_wheel_add(smc_wheel *w, solu_val fn, solu_i64 owner, uint64_t delay, uint64_t period) {
+    uint32_t i;
+    if (w->free_head) {
+        i = w->free_head - 1;
+        w->free_head = w->timers[i].next;
+    } else {
+        if (w->count == w->cap) {
+            uint32_t cap = w->cap ? w->cap * 2 : 64;
+            smc_timer *timers = realloc(w->timers, cap * sizeof(smc_timer));
+            if (!timers) abort();
+            w->timers = timers;
+            w->cap = cap;
+        }
+        i = w->count++;
+        w->timers[i] = (smc_timer){.gen = 1};
+    }
+
+    // Never due on the tick being processed, or every(0) would spin forever
+    smc_timer *t = w->timers + i;
+    t->fn = fn;
+    t->owner = owner;
+    t->expires = w->now + (delay ? delay : 1);
+    t->period = period;
+    t->active = true;
+    t->bucket = SMC_WHEEL_UNLINKED;
+    solu_dhold(fn);
+    smc_wheel_link(w, i);
+    ++w->pending;
+    return (solu_i64)(((uint64_t)t->gen << 32) | i);
+}
+
+bool smc_wheel_cancel(smc_wheel *w, solu_i64 handle) {
+    smc_timer *t = smc_wheel_get(w, handle);
+    if (!t) return false;
+    smc_wheel_release(w, (uint32_t)(t - w->timers));
+    return true;
+}
+
+static void smc_wheel_cascade(smc_wheel *w, uint32_t bucket) {
+    uint32_t head = w->buckets[bucket];
+    w->buckets[bucket] = 0;
+    while (head) {
+        uint32_t i = head - 1;
+        head = w->timers[i].next;
+        smc_wheel_link(w, i);
+    }
+}
+
+static void smc_wheel_expire(smc_wheel *w, uint32_t bucket, smc_wheel_fire fire, void *ud) {
+    // Callbacks may add or cancel timers, so pop one at a time
+    while (w->buckets[bucket]) {
+        uint32_t i = w->buckets[bucket] - 1;
+        smc_wheel_unlink(w, i);
+        smc_timer *t = w->timers + i;
+        solu_val fn = t->fn;
+        uint32_t gen = t->gen;
+        solu_dhold(fn);
+        bool keep = fire(ud, fn, t->owner);
+        solu_drelease(fn);
+
+        t = w->timers + i;
+        if (!t->active || t->gen != gen)
+            continue; // Cancelled from its own callback
+        if (!keep || !t->period) {
+            smc_wheel_release(w, i);
+            continue;
+        }
+        t->expires += t->period;
+        if (t->expires <= w->now)
+            t->expires = w->now + t->period;
+        smc_wheel_link(w, i);
+    }
+}
+
+void smc_wheel_advance(smc_wheel *w, uint64_t to, smc_wheel_fire fire, void *ud) {
+    while (w->now < to) {
+        if (!w->pending) {
+            w->now = to;
+            return;
+        }
+        ++w->now;
+
+        // Cascade every level whose window just rolled over, top down
+        uint32_t top = 0;
+        while (top < SMC_WHEEL_LEVELS && !(w->now & ((1ull << (SMC_WHEEL_BITS * (top + 1))) - 1)))
+            ++top;
+        for (uint32_t l = top; l >= 1; --l)
+            smc_wheel_cascade(w, l < SMC_WHEEL_LEVELS
+                ? l * SMC_WHEEL_SLOTS + ((w->now >> (SMC_WHEEL_BITS * l)) & SMC_WHEEL_MASK)
+                : SMC_WHEEL_BUCKETS - 1);
+
+        smc_wheel_expire(w, (uint32_t)(w->now & SMC_WHEEL_MASK), fire, ud);
+    }
+}
+
+void smc_wheel_free(smc_wheel *w) {
+    for (uint32_t i = 0; i < w->count; ++i)
+        if (w->timers[i].active)
+            solu_drelease(w->timers[i].fn);
+    free(w->timers);
+    *w = (smc_wheel){0};
+}
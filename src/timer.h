@@ -0,0 +1,42 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <solus/api.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Hierarchical timer wheel on a 1ms tick: each level covers 256 times the
+// span of the one below, anything past the top level waits on an overflow list
+#define SMC_WHEEL_BITS 8
+#define SMC_WHEEL_SLOTS (1u << SMC_WHEEL_BITS)
+#define SMC_WHEEL_MASK (SMC_WHEEL_SLOTS - 1)
+#define SMC_WHEEL_LEVELS 4
+#define SMC_WHEEL_BUCKETS (SMC_WHEEL_LEVELS * SMC_WHEEL_SLOTS + 1)
+#define SMC_WHEEL_UNLINKED UINT16_MAX
+
+// Links are indices + 1 so zero ends a list, 'next' doubles as the free list
+typedef struct {
+    solu_val fn;
+    solu_i64 owner;
+    uint64_t expires, period;
+    uint32_t next, prev, gen;
+    uint16_t bucket;
+    bool active;
+} smc_timer;
+
+typedef struct {
+    smc_timer *timers;
+    uint32_t count, cap, free_head, pending;
+    uint32_t buckets[SMC_WHEEL_BUCKETS];
+    uint64_t now;
+} smc_wheel;
+
+// Returns false to drop the timer instead of rescheduling it
+typedef bool (*smc_wheel_fire)(void *ud, solu_val fn, solu_i64 owner);
+
+solu_i64 smc_wheel_add(smc_wheel *w, solu_val fn, solu_i64 owner, uint64_t delay, uint64_t period);
+bool smc_wheel_cancel(smc_wheel *w, solu_i64 handle);
+void smc_wheel_advance(smc_wheel *w, uint64_t to, smc_wheel_fire fire, void *ud);
+void smc_wheel_free(smc_wheel *w);
+
+#endif // TIMER_H